@@ -113,6 +113,69 @@ VL53L0X_API VL53L0X_Error VL53L0X_GetProductRevision(VL53L0X_DEV Dev,
 VL53L0X_API VL53L0X_Error VL53L0X_GetDeviceInfo(VL53L0X_DEV Dev,
 	VL53L0X_DeviceInfo_t *pVL53L0X_DeviceInfo);
 
+/**
+ * @brief Reads the 64 bit unique part ID stored in the device NVM
+ *
+ * @note This function Access to the device, only the first time
+ *
+ * @param   Dev                 Device Handle
+ * @param   pPartUIDUpper       Pointer to upper 32 bits of the part ID
+ * @param   pPartUIDLower       Pointer to lower 32 bits of the part ID
+ * @return  VL53L0X_ERROR_NONE   Success
+ * @return  "Other error code"  See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_GetPartUID(VL53L0X_DEV Dev,
+	uint32_t *pPartUIDUpper, uint32_t *pPartUIDLower);
+
+/**
+ * @brief Reads the 64 bit unique part ID from the device NVM, every time
+ *
+ * Only the two ID words are read, much less bus traffic than the first
+ * VL53L0X_GetPartUID(). Meant to check that the module is still the one a
+ * VL53L0X_DeviceInfoCache_t was saved for.
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                 Device Handle
+ * @param   pPartUIDUpper       Pointer to upper 32 bits of the part ID
+ * @param   pPartUIDLower       Pointer to lower 32 bits of the part ID
+ * @return  VL53L0X_ERROR_NONE   Success
+ * @return  "Other error code"  See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_ReadPartUID(VL53L0X_DEV Dev,
+	uint32_t *pPartUIDUpper, uint32_t *pPartUIDLower);
+
+/**
+ * @brief Gets the device data the API reads from the NVM
+ *
+ * @note This function Access to the device, for the parts not read yet
+ *
+ * @param   Dev                 Device Handle
+ * @param   pCache              Receives the NVM data, to be saved by the host
+ * @return  VL53L0X_ERROR_NONE   Success
+ * @return  "Other error code"  See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_GetDeviceInfoCache(VL53L0X_DEV Dev,
+	VL53L0X_DeviceInfoCache_t *pCache);
+
+/**
+ * @brief Provides the NVM data saved by VL53L0X_GetDeviceInfoCache()
+ *
+ * The API then never reads the NVM until the next VL53L0X_DataInit(), which
+ * takes most of the bus transactions out of VL53L0X_StaticInit(). Call it
+ * after VL53L0X_DataInit(), with data saved for this very module: check
+ * the part ID with VL53L0X_ReadPartUID() first.
+ *
+ * @note This function doesn't Access to the device
+ *
+ * @param   Dev                 Device Handle
+ * @param   pCache              NVM data of the module
+ * @return  VL53L0X_ERROR_NONE   Success
+ * @return  "Other error code"  See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_SetDeviceInfoCache(VL53L0X_DEV Dev,
+	const VL53L0X_DeviceInfoCache_t *pCache);
+
 /**
  * @brief Read current status of the error register for the selected device
  *
@@ -411,6 +474,9 @@ VL53L0X_API VL53L0X_Error VL53L0X_DataInit(VL53L0X_DEV Dev);
  * the API to write tuning settings.
  * This function permit to force the usage of either external or internal
  * tuning settings.
+ * Entries may write up to 254 contiguous registers, tables in the format of
+ * vl53l0x_tuning.h can be compiled into such bursts with
+ * tools/vl53l0x_tuning_compile.py.
  *
  * @note This function Access to the device
  *
@@ -1501,6 +1567,34 @@ VL53L0X_API VL53L0X_Error VL53L0X_GetMeasurementRefSignal(VL53L0X_DEV Dev,
 VL53L0X_API VL53L0X_Error VL53L0X_GetRangingMeasurementData(VL53L0X_DEV Dev,
 	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData);
 
+/**
+ * @brief Checks data ready, reads the measurement and clears the interrupt
+ * in as few bus transactions as possible
+ *
+ * @par Function Description
+ * Does the work of @a VL53L0X_GetMeasurementDataReady(),
+ * @a VL53L0X_GetRangingMeasurementData() and @a VL53L0X_ClearInterruptMask():
+ * one burst read of the interrupt status and the result registers, then,
+ * when data is ready, one write that clears the interrupt. In single ranging
+ * mode @a StartNext starts the next measurement in that same write.
+ * The signal ref clip limit check, when enabled, adds one transaction.
+ * Unlike @a VL53L0X_ClearInterruptMask() the clear is not read back.
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                      Device Handle
+ * @param   pRangingMeasurementData  Pointer to the data structure to fill up.
+ * @param   StartNext                1 to start the next single ranging
+ * measurement, ignored in the continuous modes
+ * @param   pMeasurementDataReady    Pointer to Measurement Data Ready,
+ * nothing else was done when 0
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"       See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_GetRangingMeasurementDataFast(VL53L0X_DEV Dev,
+	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData,
+	uint8_t StartNext, uint8_t *pMeasurementDataReady);
+
 /**
  * @brief Retrieve the measurements from device for a given setup
  *
@@ -1545,6 +1639,28 @@ VL53L0X_API VL53L0X_Error VL53L0X_GetHistogramMeasurementData(VL53L0X_DEV Dev,
 VL53L0X_API VL53L0X_Error VL53L0X_PerformSingleRangingMeasurement(VL53L0X_DEV Dev,
 	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData);
 
+/**
+ * @brief Performs a single ranging measurement with the fast readout
+ *
+ * @par Function Description
+ * Same as @a VL53L0X_PerformSingleRangingMeasurement(), but waits with
+ * VL53L0X_WaitDataReady() and then polls with
+ * @a VL53L0X_GetRangingMeasurementDataFast().
+ *
+ * @note This function Access to the device
+ *
+ * @note This function change the device mode to
+ * VL53L0X_DEVICEMODE_SINGLE_RANGING
+ *
+ * @param   Dev                       Device Handle
+ * @param   pRangingMeasurementData   Pointer to the data structure to fill up.
+ * @return  VL53L0X_ERROR_NONE         Success
+ * @return  "Other error code"        See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_PerformFastSingleRangingMeasurement(
+	VL53L0X_DEV Dev,
+	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData);
+
 /**
  * @brief Performs a single histogram measurement and retrieve the histogram
  * measurement data
@@ -1893,6 +2009,33 @@ VL53L0X_API VL53L0X_Error VL53L0X_GetSpadAmbientDamperFactor(VL53L0X_DEV Dev,
 VL53L0X_API VL53L0X_Error VL53L0X_PerformRefSpadManagement(VL53L0X_DEV Dev,
 	uint32_t *refSpadCount, uint8_t *isApertureSpads);
 
+/**
+ * @brief Performs Reference Spad Management, checking the applied spads first
+ *
+ * @par Function Description
+ * When reference spads are already applied (from the device NVM by
+ * @a VL53L0X_StaticInit(), by @a VL53L0X_SetReferenceSpads() or by an
+ * earlier spad management), one reference signal measurement checks them.
+ * They are kept when the rate is within 25% of the target reference rate,
+ * otherwise this is @a VL53L0X_PerformRefSpadManagement().
+ *
+ * @note This function Access to the device
+ *
+ * @note This function change the device mode to
+ * VL53L0X_DEVICEMODE_SINGLE_RANGING
+ *
+ * @param   Dev                          Device Handle
+ * @param   refSpadCount                 Reports ref Spad Count
+ * @param   isApertureSpads              Reports if spads are of type
+ *                                       aperture or non-aperture.
+ *                                       1:=aperture, 0:=Non-Aperture
+ * @return  VL53L0X_ERROR_NONE            Success
+ * @return  VL53L0X_ERROR_REF_SPAD_INIT   Error in the Ref Spad procedure.
+ * @return  "Other error code"           See ::VL53L0X_Error
+ */
+VL53L0X_API VL53L0X_Error VL53L0X_PerformFastRefSpadManagement(
+	VL53L0X_DEV Dev, uint32_t *refSpadCount, uint8_t *isApertureSpads);
+
 /**
  * @brief Applies Reference SPAD configuration
  *
@@ -56,6 +56,9 @@ VL53L0X_Error VL53L0X_apply_offset_adjustment(VL53L0X_DEV Dev);
 VL53L0X_Error VL53L0X_perform_ref_spad_management(VL53L0X_DEV Dev,
 		uint32_t *refSpadCount, uint8_t *isApertureSpads);
 
+VL53L0X_Error VL53L0X_perform_fast_ref_spad_management(VL53L0X_DEV Dev,
+		uint32_t *refSpadCount, uint8_t *isApertureSpads);
+
 VL53L0X_Error VL53L0X_set_reference_spads(VL53L0X_DEV Dev,
 		uint32_t count, uint8_t isApertureSpads);
 
@@ -52,6 +52,15 @@ uint32_t VL53L0X_quadrature_sum(uint32_t a, uint32_t b);
 
 VL53L0X_Error VL53L0X_get_info_from_device(VL53L0X_DEV Dev, uint8_t option);
 
+VL53L0X_Error VL53L0X_get_part_uid_from_device(VL53L0X_DEV Dev,
+	uint32_t *pPartUIDUpper, uint32_t *pPartUIDLower);
+
+VL53L0X_Error VL53L0X_get_info_cache(VL53L0X_DEV Dev,
+	VL53L0X_DeviceInfoCache_t *pCache);
+
+VL53L0X_Error VL53L0X_set_info_cache(VL53L0X_DEV Dev,
+	const VL53L0X_DeviceInfoCache_t *pCache);
+
 VL53L0X_Error VL53L0X_set_vcsel_pulse_period(VL53L0X_DEV Dev,
 	VL53L0X_VcselPeriod VcselPeriodType, uint8_t VCSELPulsePeriodPCLK);
 
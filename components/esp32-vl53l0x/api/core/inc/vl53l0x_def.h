@@ -378,6 +378,30 @@ typedef struct {
 	/*!< Reference Spad Good Spad Map */
 } VL53L0X_SpadData_t;
 
+/**
+ * @struct VL53L0X_DeviceInfoCache_t
+ * @brief Device data read from the NVM
+ *
+ * Everything the API reads through the NVM strobe, kept by the host so that
+ * later boots can skip the read, see VL53L0X_SetDeviceInfoCache().
+ */
+typedef struct {
+	uint32_t PartUIDUpper; /*!< Unique Part ID Upper */
+	uint32_t PartUIDLower; /*!< Unique Part ID Lower */
+	uint8_t ModuleId; /*!< Module ID */
+	uint8_t Revision; /*!< test Revision */
+	char ProductId[VL53L0X_MAX_STRING_LENGTH];
+		/*!< Product Identifier String */
+	uint8_t ReferenceSpadCount; /*!< Factory reference SPAD count */
+	uint8_t ReferenceSpadType; /*!< Factory reference SPAD type */
+	uint8_t RefGoodSpadMap[VL53L0X_REF_SPAD_BUFFER_SIZE];
+		/*!< Reference Spad Good Spad Map */
+	FixPoint1616_t SignalRateMeasFixed400mm; /*!< Peek Signal rate
+	at 400 mm*/
+	int32_t Part2PartOffsetAdjustmentNVMMicroMeter;
+		/*!< Offset adjustment derived from the NVM */
+} VL53L0X_DeviceInfoCache_t;
+
 typedef struct {
 	FixPoint1616_t OscFrequencyMHz; /* Frequency used */
 
@@ -396,6 +420,20 @@ typedef struct {
 	uint8_t PreRangeVcselPulsePeriod;
 	 /*!< Vcsel pulse period (pll clocks) for the pre-range measurement*/
 
+	uint32_t SigmaTimingFinalRangeTimeoutMicroSecs;
+	uint8_t SigmaTimingFinalRangeVcselPulsePeriod;
+	uint32_t SigmaTimingPreRangeTimeoutMicroSecs;
+	uint8_t SigmaTimingPreRangeVcselPulsePeriod;
+	 /*!< Timing the two values below were computed for */
+	uint32_t SigmaTimingPeakVcselDurationMicroSecs;
+	 /*!< Sigma estimate: vcsel on time over pre-range and final range */
+	FixPoint1616_t SigmaTimingSigmaEstRef;
+	 /*!< Sigma estimate: reference sigma for the integration time */
+
+	uint8_t InterruptClearUnverified;
+	 /*!< The fast readout cleared the interrupt without reading it back,
+	  * and no data ready check has seen it clear since */
+
 	uint16_t SigmaEstRefArray;
 	 /*!< Reference array sigma value in 1/100th of [mm] e.g. 100 = 1mm */
 	uint16_t SigmaEstEffPulseWidth;
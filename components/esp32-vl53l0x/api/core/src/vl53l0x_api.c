@@ -27,7 +27,7 @@
  ******************************************************************************/
 
 #include "vl53l0x_api.h"
-#include "vl53l0x_tuning.h"
+#include "vl53l0x_tuning_blob.h"
 #include "vl53l0x_interrupt_threshold_settings.h"
 #include "vl53l0x_api_core.h"
 #include "vl53l0x_api_calibration.h"
@@ -111,6 +111,63 @@ VL53L0X_Error VL53L0X_GetDeviceInfo(VL53L0X_DEV Dev,
 	return Status;
 }
 
+VL53L0X_Error VL53L0X_GetPartUID(VL53L0X_DEV Dev,
+	uint32_t *pPartUIDUpper, uint32_t *pPartUIDLower)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	LOG_FUNCTION_START("");
+
+	/* Returns without device access if already read */
+	Status = VL53L0X_get_info_from_device(Dev, 4);
+
+	if (Status == VL53L0X_ERROR_NONE) {
+		*pPartUIDUpper = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			PartUIDUpper);
+		*pPartUIDLower = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			PartUIDLower);
+	}
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_ReadPartUID(VL53L0X_DEV Dev,
+	uint32_t *pPartUIDUpper, uint32_t *pPartUIDLower)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	LOG_FUNCTION_START("");
+
+	Status = VL53L0X_get_part_uid_from_device(Dev, pPartUIDUpper,
+		pPartUIDLower);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_GetDeviceInfoCache(VL53L0X_DEV Dev,
+	VL53L0X_DeviceInfoCache_t *pCache)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	LOG_FUNCTION_START("");
+
+	Status = VL53L0X_get_info_cache(Dev, pCache);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_SetDeviceInfoCache(VL53L0X_DEV Dev,
+	const VL53L0X_DeviceInfoCache_t *pCache)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	LOG_FUNCTION_START("");
+
+	Status = VL53L0X_set_info_cache(Dev, pCache);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
 VL53L0X_Error VL53L0X_GetDeviceErrorStatus(VL53L0X_DEV Dev,
 	VL53L0X_DeviceError *pDeviceErrorStatus)
 {
@@ -373,6 +430,10 @@ VL53L0X_Error VL53L0X_DataInit(VL53L0X_DEV Dev)
 
 	LOG_FUNCTION_START("");
 
+	/* Merge the register writes below into as few bus transactions
+	 * as possible */
+	VL53L0X_BeginWriteBatch(Dev);
+
 	/* by default the I2C is running at 1V8 if you want to change it you
 	 * need to include this define at compilation level. */
 #ifdef USE_I2C_2V8
@@ -500,6 +561,10 @@ VL53L0X_Error VL53L0X_DataInit(VL53L0X_DEV Dev)
 	if (Status == VL53L0X_ERROR_NONE)
 		VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, RefSpadsInitialised, 0);
 
+	if (Status == VL53L0X_ERROR_NONE)
+		Status = VL53L0X_EndWriteBatch(Dev);
+	else
+		VL53L0X_EndWriteBatch(Dev);
 
 	LOG_FUNCTION_END(Status);
 	return Status;
@@ -564,6 +629,10 @@ VL53L0X_Error VL53L0X_StaticInit(VL53L0X_DEV Dev)
 
 	LOG_FUNCTION_START("");
 
+	/* Merge the register writes below into as few bus transactions
+	 * as possible */
+	VL53L0X_BeginWriteBatch(Dev);
+
 	Status = VL53L0X_get_info_from_device(Dev, 1);
 
 	/* set the ref spad from NVM */
@@ -583,7 +652,7 @@ VL53L0X_Error VL53L0X_StaticInit(VL53L0X_DEV Dev)
 
 
 	/* Initialize tuning settings buffer to prevent compiler warning. */
-	pTuningSettingBuffer = DefaultTuningSettings;
+	pTuningSettingBuffer = DefaultTuningBlob;
 
 	if (Status == VL53L0X_ERROR_NONE) {
 		UseInternalTuningSettings = PALDevDataGet(Dev,
@@ -593,7 +662,7 @@ VL53L0X_Error VL53L0X_StaticInit(VL53L0X_DEV Dev)
 			pTuningSettingBuffer = PALDevDataGet(Dev,
 				pTuningSettingsPointer);
 		else
-			pTuningSettingBuffer = DefaultTuningSettings;
+			pTuningSettingBuffer = DefaultTuningBlob;
 
 	}
 
@@ -722,6 +791,11 @@ VL53L0X_Error VL53L0X_StaticInit(VL53L0X_DEV Dev)
 			seqTimeoutMicroSecs);
 	}
 
+	if (Status == VL53L0X_ERROR_NONE)
+		Status = VL53L0X_EndWriteBatch(Dev);
+	else
+		VL53L0X_EndWriteBatch(Dev);
+
 	LOG_FUNCTION_END(Status);
 	return Status;
 }
@@ -771,6 +845,9 @@ VL53L0X_Error VL53L0X_ResetDevice(VL53L0X_DEV Dev)
 
 	VL53L0X_PollingDelay(Dev);
 
+	/* Registers are back to their defaults */
+	VL53L0X_InvalidateShadow(Dev);
+
 	/* Set PAL State to VL53L0X_STATE_POWERDOWN */
 	if (Status == VL53L0X_ERROR_NONE)
 		PALDevDataSet(Dev, PalState, VL53L0X_STATE_POWERDOWN);
@@ -2203,6 +2280,27 @@ VL53L0X_Error VL53L0X_CheckAndLoadInterruptSettings(VL53L0X_DEV Dev,
 }
 
 
+/* Queues the stop variable sequence every start begins with, and the
+ * start itself in single ranging mode */
+static VL53L0X_Error VL53L0X_load_start_sequence(VL53L0X_DEV Dev,
+	VL53L0X_DeviceModes DeviceMode)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+
+	Status = VL53L0X_WrByte(Dev, 0x80, 0x01);
+	Status = VL53L0X_WrByte(Dev, 0xFF, 0x01);
+	Status = VL53L0X_WrByte(Dev, 0x00, 0x00);
+	Status = VL53L0X_WrByte(Dev, 0x91, PALDevDataGet(Dev, StopVariable));
+	Status = VL53L0X_WrByte(Dev, 0x00, 0x01);
+	Status = VL53L0X_WrByte(Dev, 0xFF, 0x00);
+	Status = VL53L0X_WrByte(Dev, 0x80, 0x00);
+
+	if (DeviceMode == VL53L0X_DEVICEMODE_SINGLE_RANGING)
+		Status = VL53L0X_WrByte(Dev, VL53L0X_REG_SYSRANGE_START, 0x01);
+
+	return Status;
+}
+
 VL53L0X_Error VL53L0X_StartMeasurement(VL53L0X_DEV Dev)
 {
 	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
@@ -2215,18 +2313,17 @@ VL53L0X_Error VL53L0X_StartMeasurement(VL53L0X_DEV Dev)
 	/* Get Current DeviceMode */
 	VL53L0X_GetDeviceMode(Dev, &DeviceMode);
 
-	Status = VL53L0X_WrByte(Dev, 0x80, 0x01);
-	Status = VL53L0X_WrByte(Dev, 0xFF, 0x01);
-	Status = VL53L0X_WrByte(Dev, 0x00, 0x00);
-	Status = VL53L0X_WrByte(Dev, 0x91, PALDevDataGet(Dev, StopVariable));
-	Status = VL53L0X_WrByte(Dev, 0x00, 0x01);
-	Status = VL53L0X_WrByte(Dev, 0xFF, 0x00);
-	Status = VL53L0X_WrByte(Dev, 0x80, 0x00);
+	/* Stop variable sequence and single shot start go out as one
+	 * bus transaction */
+	VL53L0X_BeginWriteBatch(Dev);
+	Status = VL53L0X_load_start_sequence(Dev, DeviceMode);
+	Status = VL53L0X_EndWriteBatch(Dev);
+	if (Status == VL53L0X_ERROR_NONE &&
+		DeviceMode == VL53L0X_DEVICEMODE_SINGLE_RANGING)
+		VL53L0X_MeasurementStarted(Dev);
 
 	switch (DeviceMode) {
 	case VL53L0X_DEVICEMODE_SINGLE_RANGING:
-		Status = VL53L0X_WrByte(Dev, VL53L0X_REG_SYSRANGE_START, 0x01);
-
 		Byte = StartStopByte;
 		if (Status == VL53L0X_ERROR_NONE) {
 			/* Wait until start bit has been cleared */
@@ -2257,6 +2354,7 @@ VL53L0X_Error VL53L0X_StartMeasurement(VL53L0X_DEV Dev)
 		VL53L0X_REG_SYSRANGE_START,
 		VL53L0X_REG_SYSRANGE_MODE_BACKTOBACK);
 		if (Status == VL53L0X_ERROR_NONE) {
+			VL53L0X_MeasurementStarted(Dev);
 			/* Set PAL State to Running */
 			PALDevDataSet(Dev, PalState, VL53L0X_STATE_RUNNING);
 		}
@@ -2272,6 +2370,7 @@ VL53L0X_Error VL53L0X_StartMeasurement(VL53L0X_DEV Dev)
 		VL53L0X_REG_SYSRANGE_MODE_TIMED);
 
 		if (Status == VL53L0X_ERROR_NONE) {
+			VL53L0X_MeasurementStarted(Dev);
 			/* Set PAL State to Running */
 			PALDevDataSet(Dev, PalState, VL53L0X_STATE_RUNNING);
 		}
@@ -2291,6 +2390,7 @@ VL53L0X_Error VL53L0X_StopMeasurement(VL53L0X_DEV Dev)
 	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
 	LOG_FUNCTION_START("");
 
+	VL53L0X_BeginWriteBatch(Dev);
 	Status = VL53L0X_WrByte(Dev, VL53L0X_REG_SYSRANGE_START,
 	VL53L0X_REG_SYSRANGE_MODE_SINGLESHOT);
 
@@ -2299,6 +2399,7 @@ VL53L0X_Error VL53L0X_StopMeasurement(VL53L0X_DEV Dev)
 	Status = VL53L0X_WrByte(Dev, 0x91, 0x00);
 	Status = VL53L0X_WrByte(Dev, 0x00, 0x01);
 	Status = VL53L0X_WrByte(Dev, 0xFF, 0x00);
+	Status = VL53L0X_EndWriteBatch(Dev);
 
 	if (Status == VL53L0X_ERROR_NONE) {
 		/* Set PAL State to Idle */
@@ -2361,7 +2462,9 @@ VL53L0X_Error VL53L0X_WaitDeviceReadyForNewMeasurement(VL53L0X_DEV Dev,
 }
 
 
-VL53L0X_Error VL53L0X_GetRangingMeasurementData(VL53L0X_DEV Dev,
+/* Fills the ranging data from the 12 result registers at 0x14 */
+static VL53L0X_Error VL53L0X_decode_ranging_data(VL53L0X_DEV Dev,
+	const uint8_t *localBuffer,
 	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData)
 {
 	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
@@ -2376,30 +2479,23 @@ VL53L0X_Error VL53L0X_GetRangingMeasurementData(VL53L0X_DEV Dev,
 	uint16_t tmpuint16;
 	uint16_t XtalkRangeMilliMeter;
 	uint16_t LinearityCorrectiveGain;
-	uint8_t localBuffer[12];
+	uint32_t StartUs;
+	uint32_t EndUs;
 	VL53L0X_RangingMeasurementData_t LastRangeDataBuffer;
 
-	LOG_FUNCTION_START("");
-
-	/*
-	 * use multi read even if some registers are not useful, result will
-	 * be more efficient
-	 * start reading at 0x14 dec20
-	 * end reading at 0x21 dec33 total 14 bytes to read
-	 */
-	Status = VL53L0X_ReadMulti(Dev, 0x14, localBuffer, 12);
-
 	if (Status == VL53L0X_ERROR_NONE) {
 
 		pRangingMeasurementData->ZoneId = 0; /* Only one zone */
-		pRangingMeasurementData->TimeStamp = 0; /* Not Implemented */
+		/* host clock, from the platform */
+		VL53L0X_GetMeasurementTimes(Dev, &StartUs, &EndUs);
+		pRangingMeasurementData->TimeStamp = EndUs;
 
 		tmpuint16 = VL53L0X_MAKEUINT16(localBuffer[11], localBuffer[10]);
 		/* cut1.1 if SYSTEM__RANGE_CONFIG if 1 range is 2bits fractional
 		 *(format 11.2) else no fractional
 		 */
 
-		pRangingMeasurementData->MeasurementTimeUsec = 0;
+		pRangingMeasurementData->MeasurementTimeUsec = EndUs - StartUs;
 
 		SignalRate = VL53L0X_FIXPOINT97TOFIXPOINT1616(
 			VL53L0X_MAKEUINT16(localBuffer[7], localBuffer[6]));
@@ -2512,6 +2608,140 @@ VL53L0X_Error VL53L0X_GetRangingMeasurementData(VL53L0X_DEV Dev,
 		PALDevDataSet(Dev, LastRangeMeasure, LastRangeDataBuffer);
 	}
 
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_GetRangingMeasurementData(VL53L0X_DEV Dev,
+	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	uint8_t localBuffer[12];
+
+	LOG_FUNCTION_START("");
+
+	/*
+	 * use multi read even if some registers are not useful, result will
+	 * be more efficient
+	 * start reading at 0x14 dec20
+	 * end reading at 0x21 dec33 total 14 bytes to read
+	 */
+	Status = VL53L0X_ReadMulti(Dev, 0x14, localBuffer, 12);
+
+	if (Status == VL53L0X_ERROR_NONE)
+		Status = VL53L0X_decode_ranging_data(Dev, localBuffer,
+			pRangingMeasurementData);
+
+	if (Status == VL53L0X_ERROR_NONE)
+		VL53L0X_MeasurementReadOut(Dev);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_GetRangingMeasurementDataFast(VL53L0X_DEV Dev,
+	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData,
+	uint8_t StartNext, uint8_t *pMeasurementDataReady)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	VL53L0X_DeviceModes DeviceMode;
+	uint8_t InterruptConfig;
+	uint8_t localBuffer[13];
+
+	LOG_FUNCTION_START("");
+
+	*pMeasurementDataReady = 0;
+
+	/*
+	 * interrupt status at 0x13 sits right before the results: data ready
+	 * and the data itself come in one burst
+	 */
+	Status = VL53L0X_ReadMulti(Dev, VL53L0X_REG_RESULT_INTERRUPT_STATUS,
+		localBuffer, 13);
+
+	if (Status == VL53L0X_ERROR_NONE) {
+		InterruptConfig = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			Pin0GpioFunctionality);
+
+		/* same test as VL53L0X_GetMeasurementDataReady() */
+		if (InterruptConfig ==
+			VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_NEW_SAMPLE_READY) {
+			if ((localBuffer[0] & 0x07) ==
+				VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_NEW_SAMPLE_READY)
+				*pMeasurementDataReady = 1;
+			if (localBuffer[0] & 0x18)
+				Status = VL53L0X_ERROR_RANGE_ERROR;
+		} else if (localBuffer[1] & 0x01) {
+			*pMeasurementDataReady = 1;
+		}
+	}
+
+	if (Status == VL53L0X_ERROR_NONE && *pMeasurementDataReady == 0)
+		/* the last blind clear took */
+		VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+			InterruptClearUnverified, 0);
+
+	if (Status != VL53L0X_ERROR_NONE || *pMeasurementDataReady == 0) {
+		LOG_FUNCTION_END(Status);
+		return Status;
+	}
+
+	/*
+	 * Ready, but not seen clear since the last blind clear and no new
+	 * GPIO1 edge: the clear may have been lost, and this the sample
+	 * already read. Clear it the checked way and wait for the next one,
+	 * at worst a sample that was new is dropped.
+	 */
+	if (VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			InterruptClearUnverified) &&
+			!VL53L0X_InterruptSinceReadOut(Dev)) {
+		*pMeasurementDataReady = 0;
+		Status = VL53L0X_ClearInterruptMask(Dev, 0);
+		LOG_FUNCTION_END(Status);
+		return Status;
+	}
+
+	VL53L0X_GetDeviceMode(Dev, &DeviceMode);
+	if (DeviceMode != VL53L0X_DEVICEMODE_SINGLE_RANGING)
+		StartNext = 0;
+
+	/*
+	 * the page selects around the signal ref clip read, the interrupt
+	 * clear and the next start are written together: one transaction
+	 * after the burst unless the ref clip check is enabled. The clear
+	 * is not read back as VL53L0X_ClearInterruptMask() does, the next
+	 * call checks it instead.
+	 */
+	VL53L0X_BeginWriteBatch(Dev);
+	Status = VL53L0X_decode_ranging_data(Dev, localBuffer + 1,
+		pRangingMeasurementData);
+
+	if (Status == VL53L0X_ERROR_NONE) {
+		Status = VL53L0X_WrByte(Dev,
+			VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+		Status |= VL53L0X_WrByte(Dev,
+			VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR, 0x00);
+	}
+
+	if (Status == VL53L0X_ERROR_NONE && StartNext)
+		Status = VL53L0X_load_start_sequence(Dev, DeviceMode);
+
+	if (Status == VL53L0X_ERROR_NONE)
+		Status = VL53L0X_EndWriteBatch(Dev);
+	else
+		VL53L0X_EndWriteBatch(Dev);
+
+	if (Status == VL53L0X_ERROR_NONE) {
+		VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+			InterruptClearUnverified, 1);
+		VL53L0X_MeasurementReadOut(Dev);
+	}
+
+	if (Status == VL53L0X_ERROR_NONE && StartNext)
+		VL53L0X_MeasurementStarted(Dev);
+	else if (Status == VL53L0X_ERROR_NONE &&
+		DeviceMode == VL53L0X_DEVICEMODE_SINGLE_RANGING)
+		PALDevDataSet(Dev, PalState, VL53L0X_STATE_IDLE);
+
 	LOG_FUNCTION_END(Status);
 	return Status;
 }
@@ -2574,6 +2804,37 @@ VL53L0X_Error VL53L0X_PerformSingleRangingMeasurement(VL53L0X_DEV Dev,
 	return Status;
 }
 
+VL53L0X_Error VL53L0X_PerformFastSingleRangingMeasurement(VL53L0X_DEV Dev,
+	VL53L0X_RangingMeasurementData_t *pRangingMeasurementData)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	uint8_t NewDataReady = 0;
+	uint32_t LoopNb = 0;
+
+	LOG_FUNCTION_START("");
+
+	Status = VL53L0X_SetDeviceMode(Dev, VL53L0X_DEVICEMODE_SINGLE_RANGING);
+
+	if (Status == VL53L0X_ERROR_NONE)
+		Status = VL53L0X_StartMeasurement(Dev);
+
+	/* just started, wait before the first burst */
+	while (Status == VL53L0X_ERROR_NONE) {
+		VL53L0X_WaitDataReady(Dev);
+		Status = VL53L0X_GetRangingMeasurementDataFast(Dev,
+			pRangingMeasurementData, 0, &NewDataReady);
+		if (NewDataReady == 1)
+			break;
+
+		LoopNb++;
+		if (LoopNb >= VL53L0X_DEFAULT_MAX_LOOP)
+			Status = VL53L0X_ERROR_TIME_OUT;
+	}
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
 VL53L0X_Error VL53L0X_SetNumberOfROIZones(VL53L0X_DEV Dev,
 	uint8_t NumberOfROIZones)
 {
@@ -2876,10 +3137,12 @@ VL53L0X_Error VL53L0X_ClearInterruptMask(VL53L0X_DEV Dev, uint32_t InterruptMask
 	/* clear bit 0 range interrupt, bit 1 error interrupt */
 	LoopCount = 0;
 	do {
+		VL53L0X_BeginWriteBatch(Dev);
 		Status = VL53L0X_WrByte(Dev,
 			VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
 		Status |= VL53L0X_WrByte(Dev,
 			VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR, 0x00);
+		Status |= VL53L0X_EndWriteBatch(Dev);
 		Status |= VL53L0X_RdByte(Dev,
 			VL53L0X_REG_RESULT_INTERRUPT_STATUS, &Byte);
 		LoopCount++;
@@ -2890,6 +3153,9 @@ VL53L0X_Error VL53L0X_ClearInterruptMask(VL53L0X_DEV Dev, uint32_t InterruptMask
 
 	if (LoopCount >= 3)
 		Status = VL53L0X_ERROR_INTERRUPT_NOT_CLEARED;
+	else if (Status == VL53L0X_ERROR_NONE)
+		VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+			InterruptClearUnverified, 0);
 
 	LOG_FUNCTION_END(Status);
 	return Status;
@@ -3033,3 +3299,17 @@ VL53L0X_Error VL53L0X_PerformRefSpadManagement(VL53L0X_DEV Dev,
 
 	return Status;
 }
+
+VL53L0X_Error VL53L0X_PerformFastRefSpadManagement(VL53L0X_DEV Dev,
+	uint32_t *refSpadCount, uint8_t *isApertureSpads)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	LOG_FUNCTION_START("");
+
+	Status = VL53L0X_perform_fast_ref_spad_management(Dev, refSpadCount,
+		isApertureSpads);
+
+	LOG_FUNCTION_END(Status);
+
+	return Status;
+}
@@ -673,6 +673,48 @@ VL53L0X_Error perform_ref_signal_measurement(VL53L0X_DEV Dev,
 	return status;
 }
 
+static VL53L0X_Error prepare_ref_signal_measurement(VL53L0X_DEV Dev,
+		uint8_t startSelect)
+{
+	VL53L0X_Error status = VL53L0X_ERROR_NONE;
+	uint8_t VhvSettings = 0;
+	uint8_t PhaseCal = 0;
+
+	/*
+	 * Reference SPAD window and reference calibration, as needed
+	 * before the reference signal rate of a SPAD map is measured.
+	 */
+	status = VL53L0X_WrByte(Dev, 0xFF, 0x01);
+
+	if (status == VL53L0X_ERROR_NONE)
+		status = VL53L0X_WrByte(Dev,
+			VL53L0X_REG_DYNAMIC_SPAD_REF_EN_START_OFFSET, 0x00);
+
+	if (status == VL53L0X_ERROR_NONE)
+		status = VL53L0X_WrByte(Dev,
+			VL53L0X_REG_DYNAMIC_SPAD_NUM_REQUESTED_REF_SPAD, 0x2C);
+
+	if (status == VL53L0X_ERROR_NONE)
+		status = VL53L0X_WrByte(Dev, 0xFF, 0x00);
+
+	if (status == VL53L0X_ERROR_NONE)
+		status = VL53L0X_WrByte(Dev,
+			VL53L0X_REG_GLOBAL_CONFIG_REF_EN_START_SELECT,
+			startSelect);
+
+
+	if (status == VL53L0X_ERROR_NONE)
+		status = VL53L0X_WrByte(Dev,
+				VL53L0X_REG_POWER_MANAGEMENT_GO1_POWER_FORCE, 0);
+
+	/* Perform ref calibration */
+	if (status == VL53L0X_ERROR_NONE)
+		status = VL53L0X_perform_ref_calibration(Dev, &VhvSettings,
+			&PhaseCal, 0);
+
+	return status;
+}
+
 VL53L0X_Error VL53L0X_perform_ref_spad_management(VL53L0X_DEV Dev,
 				uint32_t *refSpadCount,
 				uint8_t *isApertureSpads)
@@ -693,8 +735,6 @@ VL53L0X_Error VL53L0X_perform_ref_spad_management(VL53L0X_DEV Dev,
 	uint32_t signalRateDiff = 0;
 	uint32_t lastSignalRateDiff = 0;
 	uint8_t complete = 0;
-	uint8_t VhvSettings = 0;
-	uint8_t PhaseCal = 0;
 	uint32_t refSpadCount_int = 0;
 	uint8_t	 isApertureSpads_int = 0;
 
@@ -734,34 +774,7 @@ VL53L0X_Error VL53L0X_perform_ref_spad_management(VL53L0X_DEV Dev,
 	for (index = 0; index < spadArraySize; index++)
 		Dev->Data.SpadData.RefSpadEnables[index] = 0;
 
-
-	Status = VL53L0X_WrByte(Dev, 0xFF, 0x01);
-
-	if (Status == VL53L0X_ERROR_NONE)
-		Status = VL53L0X_WrByte(Dev,
-			VL53L0X_REG_DYNAMIC_SPAD_REF_EN_START_OFFSET, 0x00);
-
-	if (Status == VL53L0X_ERROR_NONE)
-		Status = VL53L0X_WrByte(Dev,
-			VL53L0X_REG_DYNAMIC_SPAD_NUM_REQUESTED_REF_SPAD, 0x2C);
-
-	if (Status == VL53L0X_ERROR_NONE)
-		Status = VL53L0X_WrByte(Dev, 0xFF, 0x00);
-
-	if (Status == VL53L0X_ERROR_NONE)
-		Status = VL53L0X_WrByte(Dev,
-			VL53L0X_REG_GLOBAL_CONFIG_REF_EN_START_SELECT,
-			startSelect);
-
-
-	if (Status == VL53L0X_ERROR_NONE)
-		Status = VL53L0X_WrByte(Dev,
-				VL53L0X_REG_POWER_MANAGEMENT_GO1_POWER_FORCE, 0);
-
-	/* Perform ref calibration */
-	if (Status == VL53L0X_ERROR_NONE)
-		Status = VL53L0X_perform_ref_calibration(Dev, &VhvSettings,
-			&PhaseCal, 0);
+	Status = prepare_ref_signal_measurement(Dev, startSelect);
 
 	if (Status == VL53L0X_ERROR_NONE) {
 		/* Enable Minimum NON-APERTURE Spads */
@@ -940,6 +953,75 @@ VL53L0X_Error VL53L0X_perform_ref_spad_management(VL53L0X_DEV Dev,
 	return Status;
 }
 
+VL53L0X_Error VL53L0X_perform_fast_ref_spad_management(VL53L0X_DEV Dev,
+				uint32_t *refSpadCount,
+				uint8_t *isApertureSpads)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	uint8_t startSelect = 0xB4;
+	uint32_t minimumSpadCount = 3;
+	uint16_t targetRefRate;
+	uint16_t rateTolerance;
+	uint16_t peakSignalRateRef = 0;
+	uint32_t count;
+	uint8_t apertureSpads;
+	uint8_t keep = 0;
+
+	/*
+	 * The full procedure measures the reference rate once per SPAD it
+	 * adds. A SPAD map that is already applied - from the device NVM by
+	 * StaticInit, from VL53L0X_set_reference_spads() or from an earlier
+	 * management - is instead measured once. It is kept when the rate is
+	 * within a quarter of the target: the search ends on whichever of two
+	 * neighbouring counts is closer to the target, at most half a step
+	 * away, and a step is a third of the rate at the minimum of three
+	 * SPADs. Otherwise the full search runs.
+	 */
+
+	if (VL53L0X_GETDEVICESPECIFICPARAMETER(Dev, RefSpadsInitialised) == 1) {
+		targetRefRate = PALDevDataGet(Dev, targetRefRate);
+		rateTolerance = targetRefRate / 4;
+		count = (uint32_t)VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			ReferenceSpadCount);
+		apertureSpads = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			ReferenceSpadType);
+
+		Status = prepare_ref_signal_measurement(Dev, startSelect);
+
+		if (Status == VL53L0X_ERROR_NONE)
+			Status = set_ref_spad_map(Dev,
+				Dev->Data.SpadData.RefSpadEnables);
+
+		if (Status == VL53L0X_ERROR_NONE)
+			Status = perform_ref_signal_measurement(Dev,
+				&peakSignalRateRef);
+
+		if (Status == VL53L0X_ERROR_NONE) {
+			if (abs(peakSignalRateRef - targetRefRate) <=
+					rateTolerance)
+				keep = 1;
+			/* Too strong even with the fewest aperture spads,
+			 * where the full search stops as well. */
+			if (apertureSpads == 1 && count == minimumSpadCount &&
+					peakSignalRateRef > targetRefRate)
+				keep = 1;
+		}
+	}
+
+	if (Status != VL53L0X_ERROR_NONE)
+		return Status;
+
+	if (keep) {
+		*refSpadCount = count;
+		*isApertureSpads = apertureSpads;
+	} else {
+		Status = VL53L0X_perform_ref_spad_management(Dev,
+			refSpadCount, isApertureSpads);
+	}
+
+	return Status;
+}
+
 VL53L0X_Error VL53L0X_set_reference_spads(VL53L0X_DEV Dev,
 				 uint32_t count, uint8_t isApertureSpads)
 {
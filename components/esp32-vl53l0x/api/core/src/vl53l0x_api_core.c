@@ -82,7 +82,7 @@ VL53L0X_Error VL53L0X_measurement_poll_for_completion(VL53L0X_DEV Dev)
 			break;
 		}
 
-		VL53L0X_PollingDelay(Dev);
+		VL53L0X_WaitDataReady(Dev);
 	} while (1);
 
 	LOG_FUNCTION_END(Status);
@@ -208,6 +208,49 @@ VL53L0X_Error VL53L0X_device_read_strobe(VL53L0X_DEV Dev)
 
 }
 
+/* Map the NVM read registers (0x90-0x94) in, for
+ * VL53L0X_device_read_strobe() */
+static VL53L0X_Error VL53L0X_nvm_read_enter(VL53L0X_DEV Dev)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	uint8_t byte;
+
+	Status |= VL53L0X_WrByte(Dev, 0x80, 0x01);
+	Status |= VL53L0X_WrByte(Dev, 0xFF, 0x01);
+	Status |= VL53L0X_WrByte(Dev, 0x00, 0x00);
+
+	Status |= VL53L0X_WrByte(Dev, 0xFF, 0x06);
+	Status |= VL53L0X_RdByte(Dev, 0x83, &byte);
+	Status |= VL53L0X_WrByte(Dev, 0x83, byte|4);
+	Status |= VL53L0X_WrByte(Dev, 0xFF, 0x07);
+	Status |= VL53L0X_WrByte(Dev, 0x81, 0x01);
+
+	Status |= VL53L0X_PollingDelay(Dev);
+
+	Status |= VL53L0X_WrByte(Dev, 0x80, 0x01);
+
+	return Status;
+}
+
+/* Back to the normal register map */
+static VL53L0X_Error VL53L0X_nvm_read_exit(VL53L0X_DEV Dev)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	uint8_t byte;
+
+	Status |= VL53L0X_WrByte(Dev, 0x81, 0x00);
+	Status |= VL53L0X_WrByte(Dev, 0xFF, 0x06);
+	Status |= VL53L0X_RdByte(Dev, 0x83, &byte);
+	Status |= VL53L0X_WrByte(Dev, 0x83, byte&0xfb);
+	Status |= VL53L0X_WrByte(Dev, 0xFF, 0x01);
+	Status |= VL53L0X_WrByte(Dev, 0x00, 0x01);
+
+	Status |= VL53L0X_WrByte(Dev, 0xFF, 0x00);
+	Status |= VL53L0X_WrByte(Dev, 0x80, 0x00);
+
+	return Status;
+}
+
 VL53L0X_Error VL53L0X_get_info_from_device(VL53L0X_DEV Dev, uint8_t option)
 {
 
@@ -242,19 +285,11 @@ VL53L0X_Error VL53L0X_get_info_from_device(VL53L0X_DEV Dev, uint8_t option)
 	 * datainit is done*/
 	if (ReadDataFromDeviceDone != 7) {
 
-		Status |= VL53L0X_WrByte(Dev, 0x80, 0x01);
-		Status |= VL53L0X_WrByte(Dev, 0xFF, 0x01);
-		Status |= VL53L0X_WrByte(Dev, 0x00, 0x00);
-
-		Status |= VL53L0X_WrByte(Dev, 0xFF, 0x06);
-		Status |= VL53L0X_RdByte(Dev, 0x83, &byte);
-		Status |= VL53L0X_WrByte(Dev, 0x83, byte|4);
-		Status |= VL53L0X_WrByte(Dev, 0xFF, 0x07);
-		Status |= VL53L0X_WrByte(Dev, 0x81, 0x01);
+		/* Each NVM word is a handful of writes followed by reads,
+		 * let the writes share bus transactions */
+		VL53L0X_BeginWriteBatch(Dev);
 
-		Status |= VL53L0X_PollingDelay(Dev);
-
-		Status |= VL53L0X_WrByte(Dev, 0x80, 0x01);
+		Status |= VL53L0X_nvm_read_enter(Dev);
 
 		if (((option & 1) == 1) &&
 			((ReadDataFromDeviceDone & 1) == 0)) {
@@ -393,15 +428,9 @@ VL53L0X_Error VL53L0X_get_info_from_device(VL53L0X_DEV Dev, uint8_t option)
 							>> 24);
 		}
 
-		Status |= VL53L0X_WrByte(Dev, 0x81, 0x00);
-		Status |= VL53L0X_WrByte(Dev, 0xFF, 0x06);
-		Status |= VL53L0X_RdByte(Dev, 0x83, &byte);
-		Status |= VL53L0X_WrByte(Dev, 0x83, byte&0xfb);
-		Status |= VL53L0X_WrByte(Dev, 0xFF, 0x01);
-		Status |= VL53L0X_WrByte(Dev, 0x00, 0x01);
+		Status |= VL53L0X_nvm_read_exit(Dev);
 
-		Status |= VL53L0X_WrByte(Dev, 0xFF, 0x00);
-		Status |= VL53L0X_WrByte(Dev, 0x80, 0x00);
+		Status |= VL53L0X_EndWriteBatch(Dev);
 	}
 
 	if ((Status == VL53L0X_ERROR_NONE) &&
@@ -474,6 +503,112 @@ VL53L0X_Error VL53L0X_get_info_from_device(VL53L0X_DEV Dev, uint8_t option)
 	return Status;
 }
 
+VL53L0X_Error VL53L0X_get_part_uid_from_device(VL53L0X_DEV Dev,
+	uint32_t *pPartUIDUpper, uint32_t *pPartUIDLower)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+	/* Two NVM words instead of the full get_info_from_device()
+	 * sequence, always from the device */
+	VL53L0X_BeginWriteBatch(Dev);
+
+	Status |= VL53L0X_nvm_read_enter(Dev);
+
+	Status |= VL53L0X_WrByte(Dev, 0x94, 0x7B);
+	Status |= VL53L0X_device_read_strobe(Dev);
+	Status |= VL53L0X_RdDWord(Dev, 0x90, pPartUIDUpper);
+
+	Status |= VL53L0X_WrByte(Dev, 0x94, 0x7C);
+	Status |= VL53L0X_device_read_strobe(Dev);
+	Status |= VL53L0X_RdDWord(Dev, 0x90, pPartUIDLower);
+
+	Status |= VL53L0X_nvm_read_exit(Dev);
+
+	Status |= VL53L0X_EndWriteBatch(Dev);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_get_info_cache(VL53L0X_DEV Dev,
+	VL53L0X_DeviceInfoCache_t *pCache)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	int i;
+
+	LOG_FUNCTION_START("");
+
+	/* Returns without device access for what was read already */
+	Status = VL53L0X_get_info_from_device(Dev, 7);
+
+	if (Status == VL53L0X_ERROR_NONE) {
+		memset(pCache, 0, sizeof(*pCache));
+		pCache->PartUIDUpper = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			PartUIDUpper);
+		pCache->PartUIDLower = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			PartUIDLower);
+		pCache->ModuleId = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			ModuleId);
+		pCache->Revision = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+			Revision);
+		VL53L0X_COPYSTRING(pCache->ProductId,
+			VL53L0X_GETDEVICESPECIFICPARAMETER(Dev, ProductId));
+		pCache->ReferenceSpadCount = VL53L0X_GETDEVICESPECIFICPARAMETER(
+			Dev, ReferenceSpadCount);
+		pCache->ReferenceSpadType = VL53L0X_GETDEVICESPECIFICPARAMETER(
+			Dev, ReferenceSpadType);
+		for (i = 0; i < VL53L0X_REF_SPAD_BUFFER_SIZE; i++)
+			pCache->RefGoodSpadMap[i] =
+				Dev->Data.SpadData.RefGoodSpadMap[i];
+		pCache->SignalRateMeasFixed400mm =
+			VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+				SignalRateMeasFixed400mm);
+		pCache->Part2PartOffsetAdjustmentNVMMicroMeter = PALDevDataGet(Dev,
+			Part2PartOffsetAdjustmentNVMMicroMeter);
+	}
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53L0X_Error VL53L0X_set_info_cache(VL53L0X_DEV Dev,
+	const VL53L0X_DeviceInfoCache_t *pCache)
+{
+	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+	char *ProductId_tmp;
+	int i;
+
+	LOG_FUNCTION_START("");
+
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, PartUIDUpper,
+		pCache->PartUIDUpper);
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, PartUIDLower,
+		pCache->PartUIDLower);
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, ModuleId, pCache->ModuleId);
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, Revision, pCache->Revision);
+	ProductId_tmp = VL53L0X_GETDEVICESPECIFICPARAMETER(Dev, ProductId);
+	VL53L0X_COPYSTRING(ProductId_tmp, pCache->ProductId);
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, ReferenceSpadCount,
+		pCache->ReferenceSpadCount);
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, ReferenceSpadType,
+		pCache->ReferenceSpadType);
+	for (i = 0; i < VL53L0X_REF_SPAD_BUFFER_SIZE; i++)
+		Dev->Data.SpadData.RefGoodSpadMap[i] =
+			pCache->RefGoodSpadMap[i];
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, SignalRateMeasFixed400mm,
+		pCache->SignalRateMeasFixed400mm);
+	PALDevDataSet(Dev, Part2PartOffsetAdjustmentNVMMicroMeter,
+		pCache->Part2PartOffsetAdjustmentNVMMicroMeter);
+
+	/* All three option groups of get_info_from_device() are known */
+	VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, ReadDataFromDeviceDone, 7);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
 
 uint32_t VL53L0X_calc_macro_period_ps(VL53L0X_DEV Dev, uint8_t vcsel_period_pclks)
 {
@@ -1352,18 +1487,20 @@ VL53L0X_Error VL53L0X_load_tuning_settings(VL53L0X_DEV Dev,
 		uint8_t *pTuningSettingBuffer)
 {
 	VL53L0X_Error Status = VL53L0X_ERROR_NONE;
-	int i;
 	int Index;
 	uint8_t msb;
 	uint8_t lsb;
 	uint8_t SelectParam;
 	uint8_t NumberOfWrites;
 	uint8_t Address;
-	uint8_t localBuffer[4]; /* max */
 	uint16_t Temp16;
 
 	LOG_FUNCTION_START("");
 
+	/* The table is write only, send it in as few transactions
+	 * as possible */
+	VL53L0X_BeginWriteBatch(Dev);
+
 	Index = 0;
 
 	while ((*(pTuningSettingBuffer + Index) != 0) &&
@@ -1412,24 +1549,24 @@ VL53L0X_Error VL53L0X_load_tuning_settings(VL53L0X_DEV Dev,
 				Status = VL53L0X_ERROR_INVALID_PARAMS;
 			}
 
-		} else if (NumberOfWrites <= 4) {
+		} else {
+			/* Up to 4 bytes in the ST tables, longer bursts in the
+			 * blobs of tools/vl53l0x_tuning_compile.py. The data is
+			 * written straight from the buffer. */
 			Address = *(pTuningSettingBuffer + Index);
 			Index++;
 
-			for (i = 0; i < NumberOfWrites; i++) {
-				localBuffer[i] = *(pTuningSettingBuffer +
-							Index);
-				Index++;
-			}
-
-			Status = VL53L0X_WriteMulti(Dev, Address, localBuffer,
-					NumberOfWrites);
-
-		} else {
-			Status = VL53L0X_ERROR_INVALID_PARAMS;
+			Status = VL53L0X_WriteMulti(Dev, Address,
+					pTuningSettingBuffer + Index, NumberOfWrites);
+			Index += NumberOfWrites;
 		}
 	}
 
+	if (Status == VL53L0X_ERROR_NONE)
+		Status = VL53L0X_EndWriteBatch(Dev);
+	else
+		VL53L0X_EndWriteBatch(Dev);
+
 	LOG_FUNCTION_END(Status);
 	return Status;
 }
@@ -1491,6 +1628,25 @@ VL53L0X_Error VL53L0X_get_total_signal_rate(VL53L0X_DEV Dev,
 	return Status;
 }
 
+/*
+ * Terms of VL53L0X_calc_dmax() that only depend on its constants, folded by
+ * the preprocessor instead of being recomputed for every range.
+ */
+
+/* signal limit 0.25: FixPoint1616 >> 8 = FixPoint2408 */
+#define VL53L0X_DMAX_SIGNAL_LIMIT_2408	((0x4000 + 0x80) >> 8)
+
+/* sigma limit 18 / 1000 as FixPoint1814 */
+#define VL53L0X_DMAX_SIGMA_LIMIT_1814	(((18 << 14) + 500) / 1000)
+
+/* sigma estimate reference 0.001 (0x42 in FixPoint1616) squared, FixPoint0428 */
+#define VL53L0X_DMAX_SIGMA_EST_REF_SQ	((0x42 * 0x42 + 0x08) >> 4)
+
+/* 4 * 12 * (sigma limit^2 - sigma est ref^2), FixPoint0428 >> 14 = FixPoint1814 */
+#define VL53L0X_DMAX_MIN_SIGNAL_NEEDED_P4 \
+	((4 * 12 * (VL53L0X_DMAX_SIGMA_LIMIT_1814 * VL53L0X_DMAX_SIGMA_LIMIT_1814 - \
+		VL53L0X_DMAX_SIGMA_EST_REF_SQ) + 0x2000) >> 14)
+
 VL53L0X_Error VL53L0X_calc_dmax(
 	VL53L0X_DEV Dev,
 	FixPoint1616_t totalSignalRate_mcps,
@@ -1501,9 +1657,6 @@ VL53L0X_Error VL53L0X_calc_dmax(
 	uint32_t peakVcselDuration_us,
 	uint32_t *pdmax_mm)
 {
-	const uint32_t cSigmaLimit		= 18;
-	const FixPoint1616_t cSignalLimit	= 0x4000; /* 0.25 */
-	const FixPoint1616_t cSigmaEstRef	= 0x00000042; /* 0.001 */
 	const uint32_t cAmbEffWidthSigmaEst_ns = 6;
 	const uint32_t cAmbEffWidthDMax_ns	   = 7;
 	uint32_t dmaxCalRange_mm;
@@ -1512,10 +1665,6 @@ VL53L0X_Error VL53L0X_calc_dmax(
 	FixPoint1616_t minSignalNeeded_p1;
 	FixPoint1616_t minSignalNeeded_p2;
 	FixPoint1616_t minSignalNeeded_p3;
-	FixPoint1616_t minSignalNeeded_p4;
-	FixPoint1616_t sigmaLimitTmp;
-	FixPoint1616_t sigmaEstSqTmp;
-	FixPoint1616_t signalLimitTmp;
 	FixPoint1616_t SignalAt0mm;
 	FixPoint1616_t dmaxDark;
 	FixPoint1616_t dmaxAmbient;
@@ -1602,27 +1751,6 @@ VL53L0X_Error VL53L0X_calc_dmax(
 
 	}
 
-	/* FixPoint1814 / uint32 = FixPoint1814 */
-	sigmaLimitTmp = ((cSigmaLimit << 14) + 500) / 1000;
-
-	/* FixPoint1814 * FixPoint1814 = FixPoint3628 := FixPoint0428 */
-	sigmaLimitTmp *= sigmaLimitTmp;
-
-	/* FixPoint1616 * FixPoint1616 = FixPoint3232 */
-	sigmaEstSqTmp = cSigmaEstRef * cSigmaEstRef;
-
-	/* FixPoint3232 >> 4 = FixPoint0428 */
-	sigmaEstSqTmp = (sigmaEstSqTmp + 0x08) >> 4;
-
-	/* FixPoint0428 - FixPoint0428	= FixPoint0428 */
-	sigmaLimitTmp -=  sigmaEstSqTmp;
-
-	/* uint32_t * FixPoint0428 = FixPoint0428 */
-	minSignalNeeded_p4 = 4 * 12 * sigmaLimitTmp;
-
-	/* FixPoint0428 >> 14 = FixPoint1814 */
-	minSignalNeeded_p4 = (minSignalNeeded_p4 + 0x2000) >> 14;
-
 	/* uint32 + uint32 = uint32 */
 	minSignalNeeded = (minSignalNeeded_p2 + minSignalNeeded_p3);
 
@@ -1634,8 +1762,8 @@ VL53L0X_Error VL53L0X_calc_dmax(
 	minSignalNeeded <<= 14;
 
 	/* FixPoint1814 / FixPoint1814 = uint32 */
-	minSignalNeeded += (minSignalNeeded_p4/2);
-	minSignalNeeded /= minSignalNeeded_p4;
+	minSignalNeeded += (VL53L0X_DMAX_MIN_SIGNAL_NEEDED_P4/2);
+	minSignalNeeded /= VL53L0X_DMAX_MIN_SIGNAL_NEEDED_P4;
 
 	/* FixPoint3200 * FixPoint2804 := FixPoint2804*/
 	minSignalNeeded *= minSignalNeeded_p1;
@@ -1652,15 +1780,9 @@ VL53L0X_Error VL53L0X_calc_dmax(
 
 	minSignalNeeded = (minSignalNeeded + 500) / 1000;
 
-	/* FixPoint1616 >> 8 = FixPoint2408 */
-	signalLimitTmp = (cSignalLimit + 0x80) >> 8;
-
 	/* FixPoint2408/FixPoint2408 = uint32 */
-	if (signalLimitTmp != 0)
-		dmaxDarkTmp = (SignalAt0mm + (signalLimitTmp / 2))
-			/ signalLimitTmp;
-	else
-		dmaxDarkTmp = 0;
+	dmaxDarkTmp = (SignalAt0mm + (VL53L0X_DMAX_SIGNAL_LIMIT_2408 / 2))
+		/ VL53L0X_DMAX_SIGNAL_LIMIT_2408;
 
 	dmaxDark = VL53L0X_isqrt(dmaxDarkTmp);
 
@@ -1779,36 +1901,90 @@ VL53L0X_Error VL53L0X_calc_sigma_estimate(VL53L0X_DEV Dev,
 
 	if (Status == VL53L0X_ERROR_NONE) {
 
-		/* Calculate final range macro periods */
 		finalRangeTimeoutMicroSecs = VL53L0X_GETDEVICESPECIFICPARAMETER(
 			Dev, FinalRangeTimeoutMicroSecs);
 
 		finalRangeVcselPCLKS = VL53L0X_GETDEVICESPECIFICPARAMETER(
 			Dev, FinalRangeVcselPulsePeriod);
 
-		finalRangeMacroPCLKS = VL53L0X_calc_timeout_mclks(
-			Dev, finalRangeTimeoutMicroSecs, finalRangeVcselPCLKS);
-
-		/* Calculate pre-range macro periods */
 		preRangeTimeoutMicroSecs = VL53L0X_GETDEVICESPECIFICPARAMETER(
 			Dev, PreRangeTimeoutMicroSecs);
 
 		preRangeVcselPCLKS = VL53L0X_GETDEVICESPECIFICPARAMETER(
 			Dev, PreRangeVcselPulsePeriod);
 
-		preRangeMacroPCLKS = VL53L0X_calc_timeout_mclks(
-			Dev, preRangeTimeoutMicroSecs, preRangeVcselPCLKS);
-
-		vcselWidth = 3;
-		if (finalRangeVcselPCLKS == 8)
-			vcselWidth = 2;
+		/* The timing terms only change with the timing budget and the
+		 * vcsel periods, recompute them when one of those changed.
+		 * The vcsel periods are never 0 once initialised, so a zeroed
+		 * device never matches. */
+		if (finalRangeTimeoutMicroSecs != VL53L0X_GETDEVICESPECIFICPARAMETER(
+				Dev, SigmaTimingFinalRangeTimeoutMicroSecs) ||
+			finalRangeVcselPCLKS != VL53L0X_GETDEVICESPECIFICPARAMETER(
+				Dev, SigmaTimingFinalRangeVcselPulsePeriod) ||
+			preRangeTimeoutMicroSecs != VL53L0X_GETDEVICESPECIFICPARAMETER(
+				Dev, SigmaTimingPreRangeTimeoutMicroSecs) ||
+			preRangeVcselPCLKS != VL53L0X_GETDEVICESPECIFICPARAMETER(
+				Dev, SigmaTimingPreRangeVcselPulsePeriod)) {
+
+			/* Calculate final range macro periods */
+			finalRangeMacroPCLKS = VL53L0X_calc_timeout_mclks(
+				Dev, finalRangeTimeoutMicroSecs, finalRangeVcselPCLKS);
+
+			/* Calculate pre-range macro periods */
+			preRangeMacroPCLKS = VL53L0X_calc_timeout_mclks(
+				Dev, preRangeTimeoutMicroSecs, preRangeVcselPCLKS);
+
+			vcselWidth = 3;
+			if (finalRangeVcselPCLKS == 8)
+				vcselWidth = 2;
+
+
+			peakVcselDuration_us = vcselWidth * 2048 *
+				(preRangeMacroPCLKS + finalRangeMacroPCLKS);
+			peakVcselDuration_us = (peakVcselDuration_us + 500)/1000;
+			peakVcselDuration_us *= cPllPeriod_ps;
+			peakVcselDuration_us = (peakVcselDuration_us + 500)/1000;
+
+			finalRangeIntegrationTimeMilliSecs =
+				(finalRangeTimeoutMicroSecs + preRangeTimeoutMicroSecs + 500)/1000;
+
+			/* sigmaEstRef = 1mm * 25ms/final range integration time (inc pre-range)
+			 * sqrt(FixPoint1616/int) = FixPoint2408)
+			 */
+			sigmaEstRef = 0;
+			if (finalRangeIntegrationTimeMilliSecs != 0)
+				sigmaEstRef =
+					VL53L0X_isqrt((cDfltFinalRangeIntegrationTimeMilliSecs +
+						finalRangeIntegrationTimeMilliSecs/2)/
+						finalRangeIntegrationTimeMilliSecs);
 
+			/* FixPoint2408 << 8 = FixPoint1616 */
+			sigmaEstRef <<= 8;
+			sigmaEstRef = (sigmaEstRef + 500)/1000;
 
-		peakVcselDuration_us = vcselWidth * 2048 *
-			(preRangeMacroPCLKS + finalRangeMacroPCLKS);
-		peakVcselDuration_us = (peakVcselDuration_us + 500)/1000;
-		peakVcselDuration_us *= cPllPeriod_ps;
-		peakVcselDuration_us = (peakVcselDuration_us + 500)/1000;
+			VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+				SigmaTimingFinalRangeTimeoutMicroSecs,
+				finalRangeTimeoutMicroSecs);
+			VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+				SigmaTimingFinalRangeVcselPulsePeriod,
+				finalRangeVcselPCLKS);
+			VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+				SigmaTimingPreRangeTimeoutMicroSecs,
+				preRangeTimeoutMicroSecs);
+			VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+				SigmaTimingPreRangeVcselPulsePeriod,
+				preRangeVcselPCLKS);
+			VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+				SigmaTimingPeakVcselDurationMicroSecs,
+				peakVcselDuration_us);
+			VL53L0X_SETDEVICESPECIFICPARAMETER(Dev,
+				SigmaTimingSigmaEstRef, sigmaEstRef);
+		} else {
+			peakVcselDuration_us = VL53L0X_GETDEVICESPECIFICPARAMETER(
+				Dev, SigmaTimingPeakVcselDurationMicroSecs);
+			sigmaEstRef = VL53L0X_GETDEVICESPECIFICPARAMETER(
+				Dev, SigmaTimingSigmaEstRef);
+		}
 
 		/* Fix1616 >> 8 = Fix2408 */
 		totalSignalRate_mcps = (totalSignalRate_mcps + 0x80) >> 8;
@@ -1953,21 +2129,6 @@ VL53L0X_Error VL53L0X_calc_sigma_estimate(VL53L0X_DEV Dev,
 			 * max result. */
 			sigmaEstRtn = cSigmaEstRtnMax;
 		}
-		finalRangeIntegrationTimeMilliSecs =
-			(finalRangeTimeoutMicroSecs + preRangeTimeoutMicroSecs + 500)/1000;
-
-		/* sigmaEstRef = 1mm * 25ms/final range integration time (inc pre-range)
-		 * sqrt(FixPoint1616/int) = FixPoint2408)
-		 */
-		sigmaEstRef =
-			VL53L0X_isqrt((cDfltFinalRangeIntegrationTimeMilliSecs +
-				finalRangeIntegrationTimeMilliSecs/2)/
-				finalRangeIntegrationTimeMilliSecs);
-
-		/* FixPoint2408 << 8 = FixPoint1616 */
-		sigmaEstRef <<= 8;
-		sigmaEstRef = (sigmaEstRef + 500)/1000;
-
 		/* FixPoint1616 * FixPoint1616 = FixPoint3232 */
 		sqr1 = sigmaEstRtn * sigmaEstRtn;
 		/* FixPoint1616 * FixPoint1616 = FixPoint3232 */
@@ -0,0 +1,110 @@
+#ifndef _VL53L0X_BUS_MANAGER_H_
+#define _VL53L0X_BUS_MANAGER_H_
+
+#include "vl53l0x_ranging_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file vl53l0x_bus_manager.h
+ *
+ * @brief Several sensors sharing one I2C port
+ *
+ * All sensors power up at the default address 0x29. The manager holds every
+ * sensor in reset through its XSHUT pin, then releases them one at a time and
+ * moves each to its own address before the next one comes up.
+ *
+ * Once the sensors are initialized, each runs a ranging service in
+ * continuous timed mode. The services start a fraction of the period apart,
+ * so the sensors range at the same time but their readouts take turns on
+ * the bus. The sensors' oscillators are not synchronized: the offsets drift
+ * slowly, which only costs the occasional wait for the bus.
+ */
+
+/**
+ * @def VL53L0X_BUS_MAX_SENSORS
+ * @brief Sensors one bus manager can handle
+ */
+#define VL53L0X_BUS_MAX_SENSORS     8
+
+/**
+ * @struct  VL53L0X_BusSensor_t
+ * @brief   One sensor on a managed bus
+ */
+typedef struct {
+    VL53L0X_Dev_t            Dev;
+    VL53L0X_RangingService_t Ranging;
+    gpio_num_t               Xshut;       /*!< host pin driving the sensor's XSHUT */
+} VL53L0X_BusSensor_t;
+
+/**
+ * @struct  VL53L0X_Bus_t
+ * @brief   State of one managed bus
+ */
+typedef struct {
+    i2c_port_t          Port;
+    uint8_t             Count;            /*!< sensors in Sensors[] */
+    uint8_t             Ranging;          /*!< ranging services running */
+    int64_t             StartUs;          /*!< esp_timer_get_time() when ranging started, does not wrap */
+    VL53L0X_BusSensor_t Sensors[VL53L0X_BUS_MAX_SENSORS];
+} VL53L0X_Bus_t;
+
+/**
+ * @brief Bring the sensors up one at a time and give each its own address
+ *
+ * Sensor i answers at FirstAddress + i afterwards. Nothing else is done to
+ * the sensors: DataInit, StaticInit and calibration are up to the caller,
+ * through pBus->Sensors[i].Dev. The I2C driver must be installed on Port.
+ *
+ * @param   pBus          Bus state, must stay valid while the sensors are used
+ * @param   Port          I2C port all sensors are wired to
+ * @param   pXshut        XSHUT pin of every sensor
+ * @param   Count         Number of sensors, at most VL53L0X_BUS_MAX_SENSORS
+ * @param   FirstAddress  7 bit address of the first sensor, not 0x29, at
+ *                        least 0x08: 0x00-0x07 and 0x78-0x7F are reserved
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  Too many sensors, a reserved address,
+ *                                    or addresses overlap 0x29
+ * @return  "Other error code"    See ::VL53L0X_Error, that sensor stays in reset
+ */
+VL53L0X_Error VL53L0X_BusAssignAddresses(VL53L0X_Bus_t *pBus, i2c_port_t Port,
+    const gpio_num_t *pXshut, uint8_t Count, uint8_t FirstAddress);
+
+/**
+ * @brief Start a ranging service on every sensor, staggered over one period
+ *
+ * @param   pBus      Bus state, sensors initialized
+ * @param   PeriodMs  Inter-measurement period of every sensor
+ * @param   Priority  FreeRTOS priority of the ranging tasks
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error, services started so far are stopped
+ */
+VL53L0X_Error VL53L0X_BusStartRanging(VL53L0X_Bus_t *pBus, uint32_t PeriodMs,
+    UBaseType_t Priority);
+
+/**
+ * @brief Stop the ranging services of all sensors
+ *
+ * @param   pBus      Bus state
+ * @return  VL53L0X_ERROR_NONE        Success
+ */
+VL53L0X_Error VL53L0X_BusStopRanging(VL53L0X_Bus_t *pBus);
+
+/**
+ * @brief Samples published by all sensors together per second since start
+ *
+ * @param   pBus      Bus state
+ * @param   pRate     Receives samples per second
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  Not ranging, or started less than 64 us ago
+ */
+VL53L0X_Error VL53L0X_BusGetSampleRate(const VL53L0X_Bus_t *pBus,
+    FixPoint1616_t *pRate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _VL53L0X_BUS_MANAGER_H_ */
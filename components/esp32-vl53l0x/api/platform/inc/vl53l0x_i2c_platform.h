@@ -0,0 +1,79 @@
+#ifndef _VL53L0X_I2C_PLATFORM_H_
+#define _VL53L0X_I2C_PLATFORM_H_
+
+#include "vl53l0x_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file vl53l0x_i2c_platform.h
+ *
+ * @brief Bus backend used by the PAL register access functions
+ *
+ * vl53l0x_platform.c implements the register access group on top of these
+ * two calls. Each call is exactly one bus transaction (START ... STOP), which
+ * is what VL53L0X_I2cStats_t counts.
+ */
+
+/**
+ * Send register writes as a single bus transaction, separated by repeated starts
+ * @param   Dev       Device Handle
+ * @param   pWrites   Register writes to send, in order
+ * @param   count     Number of entries in pWrites
+ * @param   timeoutMs Longest the transaction may take
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_i2c_write(VL53L0X_DEV Dev, const VL53L0X_I2cWrite_t *pWrites, uint8_t count,
+    uint32_t timeoutMs);
+
+/**
+ * Read consecutive registers in a single bus transaction
+ * @param   Dev       Device Handle
+ * @param   index     The register index
+ * @param   pdata     Pointer to the uint8_t buffer to store read data
+ * @param   count     Number of uint8_t's to read
+ * @param   timeoutMs Longest the transaction may take
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_i2c_read(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count,
+    uint32_t timeoutMs);
+
+#define VL53L0X_I2C_RECOVER_NONE    0x00  /*!< the bus looked fine, nothing done */
+#define VL53L0X_I2C_RECOVER_DRIVER  0x01  /*!< driver deleted and installed again */
+#define VL53L0X_I2C_RECOVER_SDA     0x02  /*!< SDA was held low, clocked free */
+#define VL53L0X_I2C_RECOVER_FAILED  0x04  /*!< a line is still low or the driver is gone */
+
+/**
+ * Bring the bus back after a failed transaction, bus mutex held
+ *
+ * Does nothing after a plain NACK (device absent or at another address).
+ * After a timeout, a driver in a bad state or with a line held low, frees
+ * the bus and reinstalls the driver, see VL53L0X_I2cInit().
+ * @param   Dev       Device Handle whose transaction failed
+ * @return  VL53L0X_I2C_RECOVER_* bits
+ */
+uint8_t VL53L0X_i2c_recover(VL53L0X_DEV Dev);
+
+/**
+ * Take the bus mutex of the device's port, see VL53L0X_CreateLocks()
+ * @param   Dev       Device Handle
+ * @param   wait      0 to return at once when another task holds the bus
+ * @return  1 when taken or when the port has no mutex, 0 when busy
+ */
+uint8_t VL53L0X_i2c_lock(VL53L0X_DEV Dev, uint8_t wait);
+
+/**
+ * Release the bus mutex taken by VL53L0X_i2c_lock()
+ * @param   Dev       Device Handle
+ */
+void VL53L0X_i2c_unlock(VL53L0X_DEV Dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _VL53L0X_I2C_PLATFORM_H_ */
@@ -32,8 +32,17 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "vl53l0x_def.h"
 #include "vl53l0x_platform_log.h"
-
+#include "vl53l0x_stats.h"
+
+#ifdef VL53L0X_PLATFORM_SIM
+#include "vl53l0x_sim.h"  /*!< host build, stands in for the headers below */
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"  /*!< user specific field */
 #include "driver/i2c.h"   /*!< user specific field */
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +60,164 @@ extern "C" {
  *  @{
  */
 
+/**
+ * @def VL53L0X_WRITE_BATCH_SIZE
+ * @brief Max number of register writes merged into one batched bus transaction
+ */
+#define VL53L0X_WRITE_BATCH_SIZE    16
+
+/**
+ * @def VL53L0X_WRITE_BATCH_BUFFER
+ * @brief Payload bytes shared by all register writes queued in a batch
+ */
+#define VL53L0X_WRITE_BATCH_BUFFER  64
+
+/**
+ * @struct  VL53L0X_I2cWrite_t
+ * @brief   One register write (index + payload) inside a bus transaction
+ */
+typedef struct {
+    uint8_t         Index;                /*!< first register index */
+    uint32_t        Count;                /*!< payload length in bytes */
+    const uint8_t  *pData;                /*!< payload, register auto-increments */
+} VL53L0X_I2cWrite_t;
+
+/**
+ * @struct  VL53L0X_WriteBatch_t
+ * @brief   Register writes queued between VL53L0X_BeginWriteBatch() and
+ *          VL53L0X_EndWriteBatch()
+ */
+typedef struct {
+    uint8_t     Depth;                    /*!< Begin/End nesting level */
+    uint8_t     Writes;                   /*!< register writes queued */
+    uint8_t     Count;                    /*!< entries used in Index/Length */
+    uint8_t     Used;                     /*!< bytes used in Buffer */
+    uint8_t     Index[VL53L0X_WRITE_BATCH_SIZE];
+    uint8_t     Length[VL53L0X_WRITE_BATCH_SIZE];
+    uint8_t     Buffer[VL53L0X_WRITE_BATCH_BUFFER];
+} VL53L0X_WriteBatch_t;
+
+/**
+ * @def VL53L0X_I2C_LATENCY_BINS
+ * @brief Transaction latency histogram bins, bin i counts transactions
+ * below 2^(i+6) us, the last one all slower ones
+ */
+#define VL53L0X_I2C_LATENCY_BINS    12
+
+/**
+ * @def VL53L0X_I2C_LATENCY_SHIFT
+ * @brief log2 of the upper bound of the first latency bin, in us
+ */
+#define VL53L0X_I2C_LATENCY_SHIFT   6
+
+/**
+ * @struct  VL53L0X_I2cStats_t
+ * @brief   Bus traffic counters, cleared by the application when needed
+ */
+typedef struct {
+    uint32_t    Transactions;             /*!< bus transactions, one per i2c_master_cmd_begin */
+    uint32_t    ReadTransactions;         /*!< part of Transactions that read data back */
+    uint32_t    MergedWrites;             /*!< register writes that rode along in another write's transaction */
+    uint32_t    BytesWritten;             /*!< payload bytes written, register index excluded */
+    uint32_t    BytesRead;                /*!< payload bytes read */
+    uint32_t    BusTimeUs;                /*!< time spent inside the bus driver */
+    uint32_t    CachedReads;              /*!< register reads answered by the shadow map */
+    uint32_t    SkippedWrites;            /*!< register writes dropped by the shadow map */
+    uint32_t    BusWaits;                 /*!< transactions that found the bus held by another task */
+    uint32_t    BusWaitUs;                /*!< time spent waiting for the bus */
+    uint32_t    DeviceWaits;              /*!< VL53L0X_LockDevice() calls that found the device held */
+    uint32_t    DeviceWaitUs;             /*!< time spent waiting for the device */
+    uint32_t    BusRecoveries;            /*!< failed transactions after which the driver was reinstalled */
+    uint32_t    SdaClears;                /*!< part of BusRecoveries, a slave held SDA low */
+    uint32_t    RecoveryFailures;         /*!< recoveries that left a line low or no driver */
+    uint32_t    Latency[VL53L0X_I2C_LATENCY_BINS]; /*!< transactions per latency bin, bus wait excluded */
+    uint32_t    LatencyMaxUs;             /*!< slowest transaction */
+    uint32_t    DeadlineMisses;           /*!< transactions that ran into their timeout */
+    uint32_t    BudgetRefusals;           /*!< transactions not started, the API call was out of time */
+    uint32_t    Samples;                  /*!< ranging results read out */
+    uint32_t    SampleTransactions;       /*!< Transactions from one readout to the next, summed over Samples */
+} VL53L0X_I2cStats_t;
+
+/**
+ * @def VL53L0X_BUS_TIMEOUT_DEFAULT_MS
+ * @brief Transaction timeout of a phase left at 0
+ */
+#define VL53L0X_BUS_TIMEOUT_DEFAULT_MS  1000
+
+#define VL53L0X_BUS_PHASE_INIT          0  /*!< reset, DataInit, StaticInit, settings */
+#define VL53L0X_BUS_PHASE_RANGING       1  /*!< measurements and their readout */
+#define VL53L0X_BUS_PHASE_CALIBRATION   2  /*!< SPAD, reference and offset calibration */
+#define VL53L0X_BUS_PHASES              3
+
+/**
+ * @struct  VL53L0X_BusDeadline_t
+ * @brief   Time limits on the bus in one phase, see VL53L0X_SetBusDeadline()
+ */
+typedef struct {
+    uint32_t    TransactionMs;            /*!< one transaction, 0 for VL53L0X_BUS_TIMEOUT_DEFAULT_MS */
+    uint32_t    CallMs;                   /*!< API call between VL53L0X_BeginCall() and VL53L0X_EndCall(), 0 for none */
+} VL53L0X_BusDeadline_t;
+
+/**
+ * @struct  VL53L0X_BusTiming_t
+ * @brief   Deadlines of a device and the API call in progress
+ */
+typedef struct {
+    VL53L0X_BusDeadline_t Deadline[VL53L0X_BUS_PHASES];
+    uint8_t     Phase;                    /*!< VL53L0X_BUS_PHASE_* in effect */
+    uint8_t     CallArmed;                /*!< CallDeadlineUs applies */
+    uint32_t    CallDeadlineUs;           /*!< VL53L0X_GetTickCountUs() the call runs out of time */
+} VL53L0X_BusTiming_t;
+
+/**
+ * @def VL53L0X_SHADOW_PAGES
+ * @brief Register pages (value of 0xFF) mirrored by the shadow map
+ */
+#define VL53L0X_SHADOW_PAGES        2
+
+#define VL53L0X_SHADOW_KNOWN_PAGE   0x01  /*!< VL53L0X_Shadow_t::Page is valid */
+#define VL53L0X_SHADOW_KNOWN_POWER  0x02  /*!< VL53L0X_Shadow_t::Power is valid */
+#define VL53L0X_SHADOW_KNOWN_MODE   0x04  /*!< VL53L0X_Shadow_t::Mode is valid */
+
+/**
+ * @struct  VL53L0X_Shadow_t
+ * @brief   Write-through copy of the device registers, see VL53L0X_SetShadowEnable()
+ */
+typedef struct {
+    uint8_t     Enabled;                  /*!< shadow map in use */
+    uint8_t     Known;                    /*!< VL53L0X_SHADOW_KNOWN_* bits */
+    uint8_t     Page;                     /*!< last value written to 0xFF */
+    uint8_t     Power;                    /*!< last value written to 0x80 */
+    uint8_t     Mode;                     /*!< last value written to 0x00 of page 1 */
+    uint8_t     Value[VL53L0X_SHADOW_PAGES][256];
+    uint32_t    Valid[VL53L0X_SHADOW_PAGES][256 / 32];
+} VL53L0X_Shadow_t;
+
+/**
+ * @struct  VL53L0X_Gpio1_t
+ * @brief   Host pin wired to the sensor's GPIO1, see VL53L0X_SetInterruptPin()
+ */
+typedef struct {
+    uint8_t     Enabled;                  /*!< data ready comes from the pin, else polling */
+    uint8_t     ActiveLevel;              /*!< pin level while the interrupt is pending */
+    uint8_t     WakeUp;                   /*!< level triggered, wakes the chip from light sleep */
+    gpio_num_t  Pin;                      /*!< host pin number */
+    TaskHandle_t volatile Task;           /*!< task blocked in VL53L0X_WaitDataReady() */
+    volatile uint32_t ReadyUs;            /*!< VL53L0X_GetTickCountUs() of the last interrupt */
+    uint32_t    Waits;                    /*!< waits that blocked on the interrupt */
+    uint32_t    Timeouts;                 /*!< waits that gave up and fell back to polling */
+} VL53L0X_Gpio1_t;
+
+/**
+ * @struct  VL53L0X_MeasurementTimes_t
+ * @brief   What VL53L0X_GetMeasurementTimes() works from
+ */
+typedef struct {
+    uint32_t    StartUs;                  /*!< last VL53L0X_StartMeasurement() */
+    uint32_t    ReadoutUs;                /*!< last VL53L0X_GetRangingMeasurementData() */
+    uint32_t    ReadoutTransactions;      /*!< i2c_stats.Transactions at that readout */
+} VL53L0X_MeasurementTimes_t;
+
 /**
  * @struct  VL53L0X_Dev_t
  * @brief    Generic PAL device type that does link between API and platform abstraction layer
@@ -63,6 +230,15 @@ typedef struct {
     uint8_t     i2c_address;              /*!< i2c device address user specific field */
     i2c_port_t  i2c_port_num;             /*!< i2c host port user specific field */
 
+    VL53L0X_WriteBatch_t write_batch;     /*!< register writes not yet sent on the bus */
+    VL53L0X_I2cStats_t   i2c_stats;       /*!< bus traffic counters */
+    VL53L0X_BusTiming_t  bus_timing;      /*!< deadlines, see VL53L0X_SetBusDeadline() */
+    VL53L0X_Stats_t      ranging_stats;   /*!< measurements read out, see VL53L0X_GetStats() */
+    VL53L0X_Shadow_t     shadow;          /*!< register values known without a bus read */
+    VL53L0X_Gpio1_t      gpio1;           /*!< data ready interrupt user specific field */
+    VL53L0X_MeasurementTimes_t measurement_times; /*!< see VL53L0X_GetMeasurementTimes() */
+    SemaphoreHandle_t    lock;            /*!< recursive mutex, see VL53L0X_CreateLocks() */
+
 } VL53L0X_Dev_t;
 
 
@@ -195,9 +371,182 @@ VL53L0X_Error VL53L0X_RdDWord(VL53L0X_DEV Dev, uint8_t index, uint32_t *data);
  */
 VL53L0X_Error VL53L0X_UpdateByte(VL53L0X_DEV Dev, uint8_t index, uint8_t AndData, uint8_t OrData);
 
+/**
+ * @brief Start queueing register writes instead of sending them one by one
+ *
+ * Writes issued until the matching VL53L0X_EndWriteBatch() are merged into
+ * as few bus transactions as possible: back-to-back writes become repeated-start
+ * segments of one transaction and writes to contiguous registers share one
+ * segment. Any read, VL53L0X_PollingDelay() or a full queue sends the pending
+ * writes first, so register ordering on the device is unchanged.
+ * Batches may nest; only the outermost End flushes. Errors of queued writes
+ * are reported by the call that sends them.
+ * Do not change @a Dev->i2c_address while a batch is open.
+ *
+ * @param   Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ */
+VL53L0X_Error VL53L0X_BeginWriteBatch(VL53L0X_DEV Dev);
+
+/**
+ * @brief Close a batch opened by VL53L0X_BeginWriteBatch()
+ *
+ * @param   Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_EndWriteBatch(VL53L0X_DEV Dev);
+
+/**
+ * @brief Send the register writes queued so far, the batch stays open
+ *
+ * @param   Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_FlushWriteBatch(VL53L0X_DEV Dev);
+
+/**
+ * @brief Turn the register shadow map on or off
+ *
+ * With the shadow map on, every register written or read is remembered and
+ * later reads of it are answered without a bus transaction, writes that would
+ * not change the register are dropped. Only registers of the normal map
+ * (page 0 and 1, 0x80 = 0x00, 0x00 of page 1 = 0x01) are mirrored, and only
+ * once the page select writes have been seen, so the hidden NVM/calibration
+ * accesses always reach the device. Registers the device updates on its own
+ * (results, interrupt status, NVM data, ids, ...) are never cached.
+ * The map starts empty and is emptied again by VL53L0X_ResetDevice() and on
+ * any bus error.
+ *
+ * @param   Dev       Device Handle
+ * @param   Enable    1 to use the shadow map, 0 to always access the bus
+ * @return  VL53L0X_ERROR_NONE        Success
+ */
+VL53L0X_Error VL53L0X_SetShadowEnable(VL53L0X_DEV Dev, uint8_t Enable);
+
+/**
+ * @brief Forget all shadowed register values and page select state
+ *
+ * Call it whenever the device may have been reset behind the API's back
+ * (XSHUT, power cycle).
+ *
+ * @param   Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ */
+VL53L0X_Error VL53L0X_InvalidateShadow(VL53L0X_DEV Dev);
+
+/**
+ * @brief Set the time limits on the bus for one phase of the device's life
+ *
+ * Each transaction gets @a TransactionMs before the driver gives up with
+ * VL53L0X_ERROR_TIME_OUT. Between VL53L0X_BeginCall() and VL53L0X_EndCall()
+ * all transactions together get @a CallMs: each one is cut to what is left
+ * and none starts once it is spent, so a polling loop of the ST API on a
+ * wedged bus ends within the budget instead of one timeout per iteration.
+ * All zeros (the default) is one second per transaction and no call limit.
+ *
+ * @param   Dev            Device Handle
+ * @param   Phase          VL53L0X_BUS_PHASE_*
+ * @param   TransactionMs  Per transaction, 0 for VL53L0X_BUS_TIMEOUT_DEFAULT_MS
+ * @param   CallMs         Per API call, 0 for no limit
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  Unknown phase
+ */
+VL53L0X_Error VL53L0X_SetBusDeadline(VL53L0X_DEV Dev, uint8_t Phase,
+    uint32_t TransactionMs, uint32_t CallMs);
+
+/**
+ * @brief Select the deadlines in effect, see VL53L0X_SetBusDeadline()
+ *
+ * @param   Dev       Device Handle
+ * @param   Phase     VL53L0X_BUS_PHASE_*
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  Unknown phase
+ */
+VL53L0X_Error VL53L0X_SetBusPhase(VL53L0X_DEV Dev, uint8_t Phase);
+
+/**
+ * @brief Start the time budget of an API call, device lock held
+ *
+ * Calls do not nest: a second Begin restarts the budget.
+ *
+ * @param   Dev       Device Handle
+ * @param   BudgetMs  Budget, 0 for the CallMs of the current phase
+ */
+void VL53L0X_BeginCall(VL53L0X_DEV Dev, uint32_t BudgetMs);
+
+/**
+ * @brief End the budget started by VL53L0X_BeginCall()
+ *
+ * @param   Dev       Device Handle
+ */
+void VL53L0X_EndCall(VL53L0X_DEV Dev);
+
 /** @} end of VL53L0X_registerAccess_group */
 
 
+/**
+ * @brief Free running microsecond clock used for bus time accounting
+ *
+ * @return  current time in us, wraps around every ~71 minutes
+ */
+uint32_t VL53L0X_GetTickCountUs(void);
+
+/**
+ * @brief Remember when a measurement was started
+ *
+ * Called by VL53L0X_StartMeasurement() once the start reached the device.
+ *
+ * @param Dev       Device Handle
+ */
+void VL53L0X_MeasurementStarted(VL53L0X_DEV Dev);
+
+/**
+ * @brief Start and end of the measurement being read out
+ *
+ * Called by VL53L0X_GetRangingMeasurementData(), which reports them as
+ * TimeStamp (end) and MeasurementTimeUsec (end - start), in the
+ * VL53L0X_GetTickCountUs() clock: esp_timer on the target, the simulated
+ * clock in host builds.
+ *
+ * The end is the GPIO1 interrupt when a pin is set and it fired after the
+ * start or the previous readout, else the readout itself, a few ms late at
+ * most when polling. The start is VL53L0X_StartMeasurement(); later
+ * measurements of the continuous modes started one timing budget before
+ * they ended.
+ *
+ * @param Dev       Device Handle
+ * @param pStartUs  Receives the start
+ * @param pEndUs    Receives the end
+ */
+void VL53L0X_GetMeasurementTimes(VL53L0X_DEV Dev, uint32_t *pStartUs,
+    uint32_t *pEndUs);
+
+/**
+ * @brief Remember that a measurement has been read out
+ *
+ * Called by VL53L0X_GetRangingMeasurementData() and
+ * VL53L0X_GetRangingMeasurementDataFast() once a sample was decoded. Counts
+ * it in Dev->i2c_stats: SampleTransactions over Samples is the bus cost of
+ * one sample, start, polls and clear included. Interrupts from before the
+ * readout no longer end a measurement, see VL53L0X_GetMeasurementTimes().
+ *
+ * @param Dev       Device Handle
+ */
+void VL53L0X_MeasurementReadOut(VL53L0X_DEV Dev);
+
+/**
+ * @brief Whether GPIO1 fired since the last readout
+ *
+ * A new interrupt edge since VL53L0X_MeasurementReadOut() means the
+ * interrupt of that readout was cleared, the edge belongs to a new one.
+ *
+ * @param Dev       Device Handle
+ * @return  1 if a pin is set and it fired since the readout, else 0
+ */
+uint8_t VL53L0X_InterruptSinceReadOut(VL53L0X_DEV Dev);
+
 /**
  * @brief execute delay in all polling API call
  *
@@ -212,6 +561,147 @@ VL53L0X_Error VL53L0X_UpdateByte(VL53L0X_DEV Dev, uint8_t index, uint8_t AndData
  */
 VL53L0X_Error VL53L0X_PollingDelay(VL53L0X_DEV Dev); /* usually best implemented as a real function */
 
+/**
+ * @brief Install the I2C master driver of a port and remember its pins
+ *
+ * The pins and clock are kept for bus recovery: after a transaction times
+ * out or leaves a line low, the bus backend takes the pins over, clocks
+ * SCL until a slave stuck in the middle of a byte lets go of SDA, sends a
+ * STOP and installs the driver again. This happens inside the failing
+ * call, which still returns its error; the next one uses the fresh driver.
+ * Recoveries are counted in Dev->i2c_stats.
+ *
+ * @param Port      I2C port
+ * @param Sda       SDA pin, internal pull-up enabled
+ * @param Scl       SCL pin, internal pull-up enabled
+ * @param ClockHz   SCL frequency
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_I2cInit(i2c_port_t Port, gpio_num_t Sda, gpio_num_t Scl,
+    uint32_t ClockHz);
+
+/**
+ * @brief Wait for a measurement to complete, between two data ready checks
+ *
+ * Blocks on the GPIO1 interrupt when a pin has been set with
+ * VL53L0X_SetInterruptPin(), otherwise same as VL53L0X_PollingDelay().
+ * Returns early if the pin is already active and gives up after the timing
+ * budget (plus inter-measurement period) and a margin, so a missed edge only
+ * costs one more poll.
+ *
+ * @param Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_WaitDataReady(VL53L0X_DEV Dev);
+
+/**
+ * @brief Use the sensor's GPIO1 output to detect data ready
+ *
+ * Configures @a Pin as an input with an edge interrupt that wakes the task
+ * waiting in VL53L0X_WaitDataReady() through its task notification, so that
+ * task should not use its notification value for anything else meanwhile.
+ * GPIO1 must be set to VL53L0X_GPIOFUNCTIONALITY_NEW_MEASURE_READY with the
+ * same polarity by VL53L0X_SetGpioConfig().
+ * Installs the GPIO ISR service if nobody did yet.
+ *
+ * @param Dev       Device Handle
+ * @param Pin       host pin wired to GPIO1, GPIO_NUM_MAX to go back to polling
+ * @param Polarity  VL53L0X_INTERRUPTPOLARITY_LOW or VL53L0X_INTERRUPTPOLARITY_HIGH
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_SetInterruptPin(VL53L0X_DEV Dev, gpio_num_t Pin,
+    VL53L0X_InterruptPolarity Polarity);
+
+/**
+ * @brief Let the GPIO1 pin wake the chip from light sleep
+ *
+ * Light sleep only wakes on a pin level, so the pin interrupt becomes level
+ * triggered: the ISR masks it after waking the waiting task, and the next
+ * VL53L0X_WaitDataReady() or VL53L0X_WaitInterrupt() unmasks it. Clear the
+ * interrupt on the sensor before waiting again. Applies to explicit
+ * (esp_light_sleep_start()) and automatic (power management) light sleep.
+ * Needs a pin set with VL53L0X_SetInterruptPin().
+ *
+ * @param Dev       Device Handle
+ * @param Enable    1 to wake on the pin, 0 for the default edge interrupt
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_GPIO_NOT_EXISTING  No interrupt pin
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_SetInterruptWakeup(VL53L0X_DEV Dev, uint8_t Enable);
+
+/**
+ * @def VL53L0X_WAIT_FOREVER
+ * @brief Timeout of VL53L0X_WaitInterrupt() that never expires
+ */
+#define VL53L0X_WAIT_FOREVER        0xFFFFFFFF
+
+/**
+ * @brief Block until the sensor raises its interrupt, whatever the GPIO1 function
+ *
+ * Unlike VL53L0X_WaitDataReady() there is no timeout derived from the
+ * timing budget: with a threshold interrupt the sensor may range for hours
+ * before a measurement crosses. The device must not be locked meanwhile.
+ *
+ * @param Dev        Device Handle
+ * @param TimeoutMs  Longest wait, VL53L0X_WAIT_FOREVER for none
+ * @return  VL53L0X_ERROR_NONE        The interrupt is pending
+ * @return  VL53L0X_ERROR_TIME_OUT    Nothing within TimeoutMs
+ * @return  VL53L0X_ERROR_GPIO_NOT_EXISTING  No interrupt pin
+ */
+VL53L0X_Error VL53L0X_WaitInterrupt(VL53L0X_DEV Dev, uint32_t TimeoutMs);
+
+/**
+ * @brief Create the device mutex and, once per port, the bus mutex
+ *
+ * Call once after setting up @a Dev, before more than one task uses it or
+ * its I2C port. Without it the device and bus are not locked at all.
+ *
+ * Every bus transaction holds the bus mutex of its port. The device mutex is
+ * taken with VL53L0X_LockDevice() around whole API call sequences, the ST API
+ * keeps state in @a Dev between register accesses (page select, write batch,
+ * shadow map) and must not be entered by two tasks at once.
+ *
+ * @param Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_UNDEFINED   Out of memory
+ */
+VL53L0X_Error VL53L0X_CreateLocks(VL53L0X_DEV Dev);
+
+/**
+ * @brief Take the device mutex, blocks while another task holds it
+ *
+ * Recursive, nested calls from the same task need as many unlocks.
+ * Waits are counted in Dev->i2c_stats.DeviceWaits.
+ *
+ * @param Dev       Device Handle
+ */
+void VL53L0X_LockDevice(VL53L0X_DEV Dev);
+
+/**
+ * @brief Release the device mutex taken by VL53L0X_LockDevice()
+ *
+ * @param Dev       Device Handle
+ */
+void VL53L0X_UnlockDevice(VL53L0X_DEV Dev);
+
+/**
+ * @brief Copy the ranging statistics of a device
+ *
+ * Takes the device mutex, so the copy is consistent even while a ranging
+ * task adds samples. Readers of the measurements (ranging service, the
+ * application's single reads) fold them in with VL53L0X_StatsAddSample()
+ * and VL53L0X_StatsAddError() on Dev->ranging_stats, holding the mutex.
+ *
+ * @param Dev       Device Handle
+ * @param pStats    Receives the statistics
+ * @param Clear     1 to start over once copied
+ */
+void VL53L0X_GetStats(VL53L0X_DEV Dev, VL53L0X_Stats_t *pStats, uint8_t Clear);
+
 /** @} end of VL53L0X_platform_group */
 
 #ifdef __cplusplus
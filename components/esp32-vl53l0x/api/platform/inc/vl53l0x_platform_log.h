@@ -34,7 +34,18 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <stdint.h>
 
+#ifdef VL53L0X_PLATFORM_SIM
+/* host build: no ESP log and no menuconfig, tracing stays compiled out */
+#define ESP_LOG_NONE    0
+#define ESP_LOG_ERROR   1
+#define ESP_LOG_WARN    2
+#define ESP_LOG_INFO    3
+#define ESP_LOG_DEBUG   4
+#define ESP_LOG_VERBOSE 5
+#else
 #include "esp_log.h"
+#include "sdkconfig.h"
+#endif
 
 /* LOG Functions */
 
@@ -73,15 +84,22 @@ enum {
     TRACE_MODULE_ALL               = 0x7fffffff //all bits except sign
 };
 
+/* Tracing backend, selected in menuconfig (VL53L0X -> API call tracing) */
+#if defined(CONFIG_VL53L0X_TRACE_LOG)
 #define VL53L0X_LOG_ENABLE
-
-#ifdef VL53L0X_LOG_ENABLE
+#elif defined(CONFIG_VL53L0X_TRACE_BINARY)
+#define VL53L0X_TRACE_BINARY
+#elif defined(CONFIG_VL53L0X_TRACE_PROFILE)
+#define VL53L0X_TRACE_PROFILE
+#endif
 
 extern uint32_t _trace_level;
 extern int _modules;
 
 int32_t VL53L0X_trace_config(char *filename, uint32_t modules, uint32_t level, uint32_t functions);
 
+#ifdef VL53L0X_LOG_ENABLE
+
 #define trace_print_module_function(module, level, function, format, ...) \
         if (level <= LOG_LOCAL_LEVEL && (module & _modules) != 0) \
             ESP_LOG_LEVEL(level, "VL53L0X", format, ##__VA_ARGS__)
@@ -97,8 +115,118 @@ int32_t VL53L0X_trace_config(char *filename, uint32_t modules, uint32_t level, u
 #define _LOG_FUNCTION_END_FMT(module, status, fmt, ... )\
         trace_print_module_function(module, _trace_level, TRACE_FUNCTION_ALL, "%u <END> %s %d "fmt"\n", LOG_GET_TIME(),  __FUNCTION__, (int)status,##__VA_ARGS__)
 
+#elif defined(VL53L0X_TRACE_BINARY)
+
+enum {
+    VL53L0X_TRACE_START = 0,
+    VL53L0X_TRACE_END   = 1
+};
+
+/**
+ * @struct  VL53L0X_TraceRecord_t
+ * @brief   One binary trace record, layout known to tools/vl53l0x_trace_decode.py
+ */
+typedef struct {
+    const char *Function;                 /*!< __FUNCTION__, resolved from the ELF by the decoder */
+    void       *Task;                     /*!< calling task, separates interleaved call trees */
+    uint32_t    TimeUs;                   /*!< VL53L0X_GetTickCountUs() */
+    int16_t     Status;                   /*!< returned status, END records only */
+    uint8_t     Event;                    /*!< VL53L0X_TRACE_START or VL53L0X_TRACE_END */
+    uint8_t     Module;                   /*!< TRACE_MODULE_* */
+} VL53L0X_TraceRecord_t;
+
+/**
+ * @brief Append a record to the trace ring, overwriting the oldest one
+ */
+void VL53L0X_trace_record(uint8_t module, uint8_t event, const char *function, int32_t status);
+
+/**
+ * @brief Print the trace ring as hex lines between VL53L0X-TRACE-BEGIN/END
+ *
+ * Best called while no API call is running, records written during the dump
+ * may come out torn.
+ */
+void VL53L0X_trace_dump(void);
+
+/**
+ * @brief Empty the trace ring
+ */
+void VL53L0X_trace_clear(void);
+
+#define trace_print_module_function(module, level, function, format, ...) (void)0
+
+#define _LOG_FUNCTION_START(module, fmt, ... ) \
+        VL53L0X_trace_record(module, VL53L0X_TRACE_START, __FUNCTION__, 0);
+
+#define _LOG_FUNCTION_END(module, status, ... ) \
+        VL53L0X_trace_record(module, VL53L0X_TRACE_END, __FUNCTION__, (int32_t)status)
+
+#define _LOG_FUNCTION_END_FMT(module, status, fmt, ... ) \
+        VL53L0X_trace_record(module, VL53L0X_TRACE_END, __FUNCTION__, (int32_t)status)
+
+#elif defined(VL53L0X_TRACE_PROFILE)
+
+/**
+ * @struct  VL53L0X_ProfileEntry_t
+ * @brief   Bus traffic of one API function, see VL53L0X_profile_dump()
+ */
+typedef struct {
+    const char *Function;                 /*!< __FUNCTION__ */
+    uint32_t    Calls;
+    uint32_t    Transactions;             /*!< issued by the function itself */
+    uint32_t    Bytes;                    /*!< payload bytes written and read by them */
+    uint32_t    BusTimeUs;                /*!< time of those in the bus driver */
+    uint32_t    TotalTransactions;        /*!< callees included */
+    uint32_t    TotalBusTimeUs;           /*!< callees included */
+} VL53L0X_ProfileEntry_t;
+
+/**
+ * @brief An API function was entered by the calling task
+ */
+void VL53L0X_profile_enter(uint8_t module, const char *function);
+
+/**
+ * @brief The API function last entered by the calling task returns
+ */
+void VL53L0X_profile_exit(uint8_t module, const char *function);
+
+/**
+ * @brief Charge a bus transaction to the innermost API function of the
+ * calling task, to "(no API function)" when there is none
+ */
+void VL53L0X_profile_transaction(uint32_t bytes, uint32_t busUs);
+
+/**
+ * @brief Print the profile, most bus time first, between
+ * VL53L0X-PROFILE-BEGIN/END
+ *
+ * Best called while no API call is running, counts updated during the dump
+ * may come out mixed.
+ */
+void VL53L0X_profile_dump(void);
+
+/**
+ * @brief Zero the profile, functions keep their entries
+ *
+ * Call it while no API call is running: the totals of a call in progress
+ * would include traffic from before the clear.
+ */
+void VL53L0X_profile_clear(void);
+
+#define trace_print_module_function(module, level, function, format, ...) (void)0
+
+#define _LOG_FUNCTION_START(module, fmt, ... ) \
+        VL53L0X_profile_enter(module, __FUNCTION__);
+
+#define _LOG_FUNCTION_END(module, status, ... ) \
+        VL53L0X_profile_exit(module, __FUNCTION__)
+
+#define _LOG_FUNCTION_END_FMT(module, status, fmt, ... ) \
+        VL53L0X_profile_exit(module, __FUNCTION__)
+
 #else /* VL53L0X_LOG_ENABLE no logging */
     #define VL53L0X_ErrLog(...) (void)0
+    #define trace_print_module_function(module, level, function, format, ...) (void)0
     #define _LOG_FUNCTION_START(module, fmt, ... ) (void)0
     #define _LOG_FUNCTION_END(module, status, ... ) (void)0
     #define _LOG_FUNCTION_END_FMT(module, status, fmt, ... ) (void)0
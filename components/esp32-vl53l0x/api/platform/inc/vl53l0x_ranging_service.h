@@ -0,0 +1,209 @@
+#ifndef _VL53L0X_RANGING_SERVICE_H_
+#define _VL53L0X_RANGING_SERVICE_H_
+
+#include "vl53l0x_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file vl53l0x_ranging_service.h
+ *
+ * @brief Background task keeping a sensor in continuous timed ranging
+ *
+ * The task owns the device while it runs and publishes every measurement
+ * into a small ring. Readers on any task or core take samples out of the
+ * ring without locking and without touching the bus: each slot carries a
+ * sequence number that is odd while the task rewrites it, a reader copies
+ * the slot and checks the sequence again afterwards. A change means the
+ * sample was overwritten by a newer one: VL53L0X_GetRangingSample() then
+ * fails, VL53L0X_GetLatestRanging() takes the newer sample instead.
+ */
+
+/**
+ * @def VL53L0X_RANGING_RING_SIZE
+ * @brief Published samples kept for readers, must be a power of two
+ */
+#define VL53L0X_RANGING_RING_SIZE   8
+
+/**
+ * @struct  VL53L0X_RangingSample_t
+ * @brief   One published measurement
+ */
+typedef struct {
+    uint32_t    Number;                   /*!< 0 for the first sample after start */
+    uint32_t    TimeUs;                   /*!< VL53L0X_GetTickCountUs() when published */
+    FixPoint1616_t SigmaMilliMeter;       /*!< sigma estimate of the range */
+    VL53L0X_RangingMeasurementData_t Data; /*!< TimeStamp: when it was measured, same clock */
+} VL53L0X_RangingSample_t;
+
+/**
+ * @brief Brings a device back after it failed, see VL53L0X_SetRangingReinit()
+ *
+ * Called by the ranging task with the device locked and stopped. Reset and
+ * set up the sensor as before (init, calibration, GPIO1 as data ready,
+ * timing budget); the task then restarts continuous timed ranging.
+ */
+typedef VL53L0X_Error (*VL53L0X_ReinitFunc_t)(VL53L0X_DEV Dev, void *pArg);
+
+/**
+ * @brief Applies new settings, see VL53L0X_ReconfigureRangingService()
+ *
+ * Called with the device locked and stopped. Change the settings (timing
+ * budget, sequence steps, limits); the caller restarts continuous timed
+ * ranging.
+ */
+typedef VL53L0X_Error (*VL53L0X_ConfigureFunc_t)(VL53L0X_DEV Dev, void *pArg);
+
+typedef struct {
+    volatile uint32_t       Sequence;     /*!< odd while the slot is written */
+    VL53L0X_RangingSample_t Sample;
+} VL53L0X_RangingSlot_t;
+
+/**
+ * @struct  VL53L0X_RangingService_t
+ * @brief   State of one ranging service, one per device
+ */
+typedef struct {
+    VL53L0X_DEV         Dev;
+    uint32_t            PeriodMs;         /*!< inter-measurement period */
+    TaskHandle_t volatile Task;           /*!< NULL once stopped */
+    volatile uint8_t    Running;          /*!< cleared to ask the task to stop */
+    volatile uint8_t    Exited;           /*!< set by the task once the device stopped */
+    volatile uint32_t   Generation;       /*!< bumped by every start */
+    volatile uint32_t   Published;        /*!< samples published since start */
+    uint32_t            Errors;           /*!< API errors seen by the task */
+    VL53L0X_ReinitFunc_t volatile Reinit; /*!< NULL to only back off on errors */
+    void               *pReinitArg;
+    uint32_t            Reinits;          /*!< device brought back by Reinit */
+    uint32_t            ReinitFailures;   /*!< Reinit or the restart failed */
+    VL53L0X_RangingSlot_t Ring[VL53L0X_RANGING_RING_SIZE];
+} VL53L0X_RangingService_t;
+
+/**
+ * @brief Put the device in continuous timed ranging and start publishing
+ *
+ * The device must be initialized (DataInit, StaticInit, calibration). Until
+ * VL53L0X_StopRangingService() returns, nothing else may range with @a Dev.
+ * A start, also a restart of a stopped service, numbers samples from 0
+ * again and bumps the generation, see VL53L0X_GetRangingGeneration().
+ * The task holds the device lock (VL53L0X_LockDevice()) while it talks to
+ * the sensor, in the VL53L0X_BUS_PHASE_RANGING bus phase, and gives every
+ * readout that phase's call budget.
+ *
+ * @param   pService  Service state, zeroed before the first start (a
+ *                    static does), must stay valid until stopped
+ * @param   Dev       Device Handle
+ * @param   PeriodMs  Inter-measurement period, at least the timing budget
+ * @param   Priority  FreeRTOS priority of the ranging task
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_StartRangingService(VL53L0X_RangingService_t *pService,
+    VL53L0X_DEV Dev, uint32_t PeriodMs, UBaseType_t Priority);
+
+/**
+ * @brief Stop the ranging task and the device, waits for the task to exit
+ *
+ * Wakes the task from a data ready wait or a reinit backoff, so the stop
+ * takes about one readout and the device stop, not a whole period.
+ *
+ * @param   pService  Service state
+ * @return  VL53L0X_ERROR_NONE        Success
+ */
+VL53L0X_Error VL53L0X_StopRangingService(VL53L0X_RangingService_t *pService);
+
+/**
+ * @brief Change the settings of a running service, keeping its task
+ *
+ * Under the device lock: stops the measurement, clears the interrupt,
+ * calls @a Configure and restarts continuous timed ranging every
+ * @a PeriodMs. No task is stopped or created, so this takes the time of
+ * the settings themselves (a few ms), where a stop and start takes up to
+ * a readout plus a task's setup. The generation does not change: sample
+ * numbers go on, and samples from *@a pFirstNumber on are read out with
+ * the new settings. On failure the device may be stopped, the task then
+ * sees errors and reinitializes it if VL53L0X_SetRangingReinit() was set.
+ *
+ * @param   pService      Service state, running
+ * @param   PeriodMs      New inter-measurement period, at least the new
+ *                        timing budget
+ * @param   Configure     Applies the settings
+ * @param   pArg          Passed to @a Configure
+ * @param   pFirstNumber  Receives the number of the first sample with the
+ *                        new settings, may be NULL
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  The service is not running
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_ReconfigureRangingService(
+    VL53L0X_RangingService_t *pService, uint32_t PeriodMs,
+    VL53L0X_ConfigureFunc_t Configure, void *pArg, uint32_t *pFirstNumber);
+
+/**
+ * @brief Reinitialize the device in the background when it stops answering
+ *
+ * After a few errors in a row, or no measurement for several periods, the
+ * ranging task calls @a Reinit and restarts ranging, backing off longer
+ * after each failed attempt. Meanwhile readers simply see no new samples.
+ * Call after VL53L0X_StartRangingService(), the setting is cleared by
+ * every start.
+ *
+ * @param   pService  Service state
+ * @param   Reinit    Brings the device back, NULL to never reinitialize
+ * @param   pArg      Passed to @a Reinit
+ */
+void VL53L0X_SetRangingReinit(VL53L0X_RangingService_t *pService,
+    VL53L0X_ReinitFunc_t Reinit, void *pArg);
+
+/**
+ * @brief Generation of the service, changed by every start
+ *
+ * Sample numbers only compare within one generation. A reader that keeps
+ * the number of the next sample to take keeps the generation with it, and
+ * starts over from sample 0 when the generation changed. Read it before
+ * VL53L0X_GetRangingCount(): a new generation comes with the new count.
+ *
+ * @param   pService  Service state
+ * @return  generation, any value the first time
+ */
+uint32_t VL53L0X_GetRangingGeneration(const VL53L0X_RangingService_t *pService);
+
+/**
+ * @brief Number of samples published since the service started
+ *
+ * @param   pService  Service state
+ * @return  sample count, the newest sample has number count - 1
+ */
+uint32_t VL53L0X_GetRangingCount(const VL53L0X_RangingService_t *pService);
+
+/**
+ * @brief Copy a published sample out of the ring
+ *
+ * @param   pService  Service state
+ * @param   Number    Sample number, only the last VL53L0X_RANGING_RING_SIZE are kept
+ * @param   pSample   Receives the sample
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  Not published yet, or overwritten
+ *                                    before or while it was copied
+ */
+VL53L0X_Error VL53L0X_GetRangingSample(const VL53L0X_RangingService_t *pService,
+    uint32_t Number, VL53L0X_RangingSample_t *pSample);
+
+/**
+ * @brief Copy the newest published sample, never blocks
+ *
+ * @param   pService  Service state
+ * @param   pSample   Receives the sample
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_INVALID_PARAMS  Nothing published yet
+ */
+VL53L0X_Error VL53L0X_GetLatestRanging(const VL53L0X_RangingService_t *pService,
+    VL53L0X_RangingSample_t *pSample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _VL53L0X_RANGING_SERVICE_H_ */
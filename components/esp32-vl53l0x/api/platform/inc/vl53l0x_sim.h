@@ -0,0 +1,154 @@
+#ifndef _VL53L0X_SIM_H_
+#define _VL53L0X_SIM_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file vl53l0x_sim.h
+ *
+ * @brief Register level model of the VL53L0X for host builds
+ *
+ * Built with VL53L0X_PLATFORM_SIM defined, vl53l0x_i2c_sim.c replaces the
+ * ESP32 bus backend: bus transactions go to in-memory sensors attached to a
+ * simulated I2C port, and VL53L0X_GetTickCountUs() returns a simulated clock
+ * that only moves with bus traffic and delays. Dev->i2c_stats.BusTimeUs then
+ * is the bus time the same call sequence would take on the target, so bus
+ * optimizations can be compared without a board.
+ *
+ * The model covers what the ST API relies on: paged register map, the NVM
+ * read strobe, address change, ranging start/stop in all modes, interrupt
+ * status and thresholds, and scripted range results. There is no optical
+ * model: the reference return grows linearly with the enabled reference
+ * SPADs and ranges come from the script.
+ *
+ * The host tests and benchmarks in components/esp32-vl53l0x/test build
+ * this way, "make -C components/esp32-vl53l0x/test" runs the tests and the
+ * "bench" target the benchmarks. A test starts like this:
+ *
+ * @code
+ * static VL53L0X_SimDevice_t sensor;
+ * VL53L0X_Dev_t dev = { .i2c_address = 0x29, .i2c_port_num = 0 };
+ *
+ * VL53L0X_SimReset(&sensor);
+ * VL53L0X_SimAttach(0, &sensor);
+ * VL53L0X_DataInit(&dev);
+ * ...
+ * @endcode
+ */
+
+/* ESP-IDF types used by vl53l0x_platform.h */
+typedef int             i2c_port_t;
+typedef int             gpio_num_t;
+typedef void           *TaskHandle_t;
+typedef void           *SemaphoreHandle_t;
+typedef unsigned int    UBaseType_t;
+
+#define GPIO_NUM_MAX    40
+
+/**
+ * @def VL53L0X_SIM_PORTS
+ * @brief Simulated I2C ports
+ */
+#define VL53L0X_SIM_PORTS           2
+
+/**
+ * @def VL53L0X_SIM_DEVICES
+ * @brief Sensors that can be attached to one simulated port
+ */
+#define VL53L0X_SIM_DEVICES         4
+
+/**
+ * @def VL53L0X_SIM_PAGES
+ * @brief Register pages (value of 0xFF) held by the model
+ */
+#define VL53L0X_SIM_PAGES           8
+
+/**
+ * @struct  VL53L0X_SimRange_t
+ * @brief   One scripted measurement result
+ */
+typedef struct {
+    uint16_t    RangeMilliMeter;
+    uint8_t     DeviceRangeStatus;        /*!< 11 is a valid range */
+    uint16_t    SignalRateRtn;            /*!< MCPS, fixed point 9.7 */
+    uint16_t    AmbientRateRtn;           /*!< MCPS, fixed point 9.7 */
+    uint16_t    EffectiveSpadRtnCount;    /*!< fixed point 8.8 */
+} VL53L0X_SimRange_t;
+
+/**
+ * @struct  VL53L0X_SimDevice_t
+ * @brief   State of one simulated sensor
+ *
+ * Fields above the register map may be changed by the test at any time.
+ */
+typedef struct {
+    uint8_t     Enabled;                  /*!< XSHUT high, the sensor answers on the bus */
+    uint32_t    MeasurementUs;            /*!< duration of a ranging measurement */
+    uint16_t    RefSpadSignalRate;        /*!< reference return per enabled reference SPAD, MCPS 9.7 */
+    const VL53L0X_SimRange_t *pScript;    /*!< results, repeated in a loop, NULL for DefaultRange */
+    uint32_t    ScriptLength;             /*!< entries in pScript */
+    VL53L0X_SimRange_t DefaultRange;      /*!< result when there is no script */
+    uint32_t    DropClears;               /*!< interrupt clears to ignore, a clear that did not take */
+
+    uint8_t     Address;                  /*!< 7 bit bus address */
+    uint8_t     Page;                     /*!< last value written to 0xFF */
+    uint8_t     Regs[VL53L0X_SIM_PAGES][256];
+    uint32_t    Nvm[128];                 /*!< words read through the 0x94/0x83/0x90 strobe */
+
+    uint8_t     Ranging;                  /*!< measurement in progress */
+    uint8_t     Continuous;               /*!< restart after each measurement */
+    uint32_t    StartUs;                  /*!< simulated time the measurement started */
+    uint32_t    ReadyUs;                  /*!< simulated time the measurement completes */
+    uint32_t    InterruptUs;              /*!< simulated time GPIO1 last became active */
+
+    uint32_t    Measurements;             /*!< measurements completed since reset */
+    uint32_t    Transactions;             /*!< bus transactions addressed to the sensor */
+    uint32_t    BusTimeUs;                /*!< bus time of those transactions */
+} VL53L0X_SimDevice_t;
+
+/**
+ * @brief Power-on state: address 0x29, factory NVM, 500 mm target
+ *
+ * @param   pSim      Sensor to reset
+ */
+void VL53L0X_SimReset(VL53L0X_SimDevice_t *pSim);
+
+/**
+ * @brief Connect a sensor to a simulated port
+ *
+ * @param   Port      Port number, as in VL53L0X_Dev_t::i2c_port_num
+ * @param   pSim      Sensor, must stay valid until VL53L0X_SimDetachAll()
+ * @return  0 on success, -1 if the port is full
+ */
+int VL53L0X_SimAttach(i2c_port_t Port, VL53L0X_SimDevice_t *pSim);
+
+/**
+ * @brief Disconnect all sensors and rewind the simulated clock to 0
+ */
+void VL53L0X_SimDetachAll(void);
+
+/**
+ * @brief Bus timing used for the simulated clock
+ *
+ * @param   ClockHz         SCL frequency, 400 kHz by default
+ * @param   TransactionUs   fixed cost per transaction (driver, task switch),
+ *                          50 us by default
+ */
+void VL53L0X_SimSetBusTiming(uint32_t ClockHz, uint32_t TransactionUs);
+
+/**
+ * @brief Move the simulated clock forward, measurements complete on the way
+ *
+ * @param   Us        microseconds to advance
+ */
+void VL53L0X_SimAdvance(uint32_t Us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _VL53L0X_SIM_H_ */
@@ -0,0 +1,174 @@
+#ifndef _VL53L0X_STATS_H_
+#define _VL53L0X_STATS_H_
+
+#include <stddef.h>
+#include "vl53l0x_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file vl53l0x_stats.h
+ *
+ * @brief Ranging statistics of one device, in fixed memory
+ *
+ * Every measurement taken through the platform (ranging service, single
+ * reads of the application) is folded into counters, a range status
+ * histogram, a latency histogram and streaming quantile estimates of range
+ * and return signal rate. Nothing grows with the number of samples: the
+ * quantiles use the P-square algorithm (Jain and Chlamtac, 1985), five
+ * markers per quantile and a constant amount of work per sample.
+ */
+
+/**
+ * @def VL53L0X_STATS_STATUS_BINS
+ * @brief Range status histogram bins, the last one counts statuses 5 and up
+ */
+#define VL53L0X_STATS_STATUS_BINS   6
+
+/**
+ * @def VL53L0X_STATS_QUANTILES
+ * @brief Quantiles estimated per variable, see VL53L0X_STATS_QUANTILE_PERCENT
+ */
+#define VL53L0X_STATS_QUANTILES     3
+
+/**
+ * @def VL53L0X_STATS_QUANTILE_PERCENT
+ * @brief Quantiles estimated, in percent
+ */
+#define VL53L0X_STATS_QUANTILE_PERCENT  { 10, 50, 90 }
+
+/**
+ * @def VL53L0X_STATS_LATENCY_BINS
+ * @brief Latency histogram bins, bin i counts latencies below 2^(i+7) us,
+ * the last one all slower ones
+ */
+#define VL53L0X_STATS_LATENCY_BINS  12
+
+/**
+ * @struct  VL53L0X_Quantile_t
+ * @brief   P-square estimator of one quantile
+ */
+typedef struct {
+    float       Height[5];                /*!< marker heights, Height[2] is the estimate */
+    int32_t     Position[5];              /*!< marker positions, 1 based */
+    float       Desired[5];               /*!< desired marker positions */
+    float       Increment[5];             /*!< desired position increment per sample */
+    uint32_t    Count;                    /*!< samples seen */
+} VL53L0X_Quantile_t;
+
+/**
+ * @struct  VL53L0X_Stats_t
+ * @brief   Ranging statistics of one device, see VL53L0X_GetStats()
+ *
+ * All zeros is a valid empty state.
+ */
+typedef struct {
+    uint32_t    Samples;                  /*!< measurements read out */
+    uint32_t    Status[VL53L0X_STATS_STATUS_BINS]; /*!< samples per range status */
+    uint32_t    Errors;                   /*!< API calls of a measurement that failed */
+    uint32_t    Timeouts;                 /*!< part of Errors, VL53L0X_ERROR_TIME_OUT */
+    uint32_t    BusErrors;                /*!< part of Errors, VL53L0X_ERROR_CONTROL_INTERFACE */
+    VL53L0X_Error LastError;              /*!< most recent error, VL53L0X_ERROR_NONE if none */
+    uint32_t    Latency[VL53L0X_STATS_LATENCY_BINS]; /*!< samples per latency bin */
+    uint32_t    LatencyMaxUs;             /*!< slowest sample */
+    uint64_t    LatencySumUs;             /*!< for the mean */
+    uint64_t    AmbientSum;               /*!< ambient rate, MCPS 16.16, for the mean */
+    uint64_t    SigmaSum;                 /*!< sigma estimate, mm 16.16, for the mean */
+    VL53L0X_Quantile_t Range[VL53L0X_STATS_QUANTILES];  /*!< mm, valid samples only */
+    VL53L0X_Quantile_t Signal[VL53L0X_STATS_QUANTILES]; /*!< MCPS, all samples */
+} VL53L0X_Stats_t;
+
+/**
+ * @brief Clear all statistics, same as filling them with zeros
+ *
+ * @param   pStats    Statistics
+ */
+void VL53L0X_StatsClear(VL53L0X_Stats_t *pStats);
+
+/**
+ * @brief Fold one measurement into the statistics
+ *
+ * @param   pStats           Statistics
+ * @param   pData            Measurement as read from the device
+ * @param   SigmaMilliMeter  Sigma estimate of the measurement, 16.16
+ * @param   LatencyUs        Time the reader waited for the measurement
+ */
+void VL53L0X_StatsAddSample(VL53L0X_Stats_t *pStats,
+    const VL53L0X_RangingMeasurementData_t *pData,
+    FixPoint1616_t SigmaMilliMeter, uint32_t LatencyUs);
+
+/**
+ * @brief Count a failed measurement
+ *
+ * @param   pStats    Statistics
+ * @param   Error     Status of the API call that failed
+ */
+void VL53L0X_StatsAddError(VL53L0X_Stats_t *pStats, VL53L0X_Error Error);
+
+/**
+ * @brief Current estimate of a quantile
+ *
+ * @param   pQuantile  Estimator
+ * @return  estimate, 0 before the first sample
+ */
+float VL53L0X_StatsQuantile(const VL53L0X_Quantile_t *pQuantile);
+
+/**
+ * @brief Latency under which a share of the samples were read
+ *
+ * @param   pStats    Statistics
+ * @param   Percent   Share of the samples, 1 to 100
+ * @return  upper bound of the latency bin holding that sample, at most
+ *          LatencyMaxUs, in us
+ */
+uint32_t VL53L0X_StatsLatencyPercentile(const VL53L0X_Stats_t *pStats,
+    uint8_t Percent);
+
+/**
+ * @brief Count one latency in a log2 histogram
+ *
+ * Bin i counts latencies below 2^(i + FirstShift) us, the last bin all
+ * slower ones.
+ *
+ * @param   pBins       Histogram
+ * @param   Bins        Number of bins
+ * @param   FirstShift  log2 of the upper bound of bin 0, in us
+ * @param   LatencyUs   Latency to count
+ */
+void VL53L0X_HistogramAdd(uint32_t *pBins, uint8_t Bins, uint8_t FirstShift,
+    uint32_t LatencyUs);
+
+/**
+ * @brief Latency under which a share of a log2 histogram's entries fall
+ *
+ * @param   pBins       Histogram, see VL53L0X_HistogramAdd()
+ * @param   Bins        Number of bins
+ * @param   FirstShift  log2 of the upper bound of bin 0, in us
+ * @param   MaxUs       Largest latency counted
+ * @param   Percent     Share of the entries, 1 to 100
+ * @return  upper bound of the bin holding that entry, at most MaxUs, in us
+ */
+uint32_t VL53L0X_HistogramPercentile(const uint32_t *pBins, uint8_t Bins,
+    uint8_t FirstShift, uint32_t MaxUs, uint8_t Percent);
+
+/**
+ * @brief Write the statistics as text, one "key=value" field per word
+ *
+ * Meant for a console or a serial line: one line per group of fields,
+ * each ended with a newline.
+ *
+ * @param   pStats    Statistics, a copy taken with VL53L0X_GetStats()
+ * @param   pBuffer   Receives the text, always terminated
+ * @param   Size      Size of pBuffer
+ * @return  length of the text, as snprintf() (larger than Size - 1 if cut)
+ */
+int VL53L0X_StatsFormat(const VL53L0X_Stats_t *pStats, char *pBuffer,
+    size_t Size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* _VL53L0X_STATS_H_ */
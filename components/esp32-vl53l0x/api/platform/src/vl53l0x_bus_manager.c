@@ -0,0 +1,135 @@
+#include "vl53l0x_bus_manager.h"
+#include "vl53l0x_api.h"
+
+// needs FreeRTOS tasks and XSHUT pins, not part of the host build
+#ifndef VL53L0X_PLATFORM_SIM
+
+#include "esp_timer.h"
+
+#define VL53L0X_DEFAULT_ADDRESS 0x29
+
+// 7 bit addresses 0x00-0x07 and 0x78-0x7F are reserved by the I2C spec
+#define I2C_FIRST_ADDRESS       0x08
+#define I2C_END_ADDRESS         0x78
+
+// XSHUT low pulse and tBOOT (1.2 ms max), rounded up to whole ticks
+#define XSHUT_RESET_MS          1
+#define XSHUT_BOOT_MS           2
+
+static void xshut_set(gpio_num_t pin, uint32_t level, uint32_t ms)
+{
+    gpio_set_level(pin, level);
+    vTaskDelay(ms / portTICK_RATE_MS + 1);
+}
+
+VL53L0X_Error VL53L0X_BusAssignAddresses(VL53L0X_Bus_t *pBus, i2c_port_t Port,
+    const gpio_num_t *pXshut, uint8_t Count, uint8_t FirstAddress)
+{
+    VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+    gpio_config_t conf;
+
+    if (Count > VL53L0X_BUS_MAX_SENSORS || FirstAddress < I2C_FIRST_ADDRESS ||
+            FirstAddress + Count > I2C_END_ADDRESS ||
+            (FirstAddress <= VL53L0X_DEFAULT_ADDRESS &&
+             FirstAddress + Count > VL53L0X_DEFAULT_ADDRESS))
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    memset(pBus, 0, sizeof(*pBus));
+    pBus->Port = Port;
+
+    // everybody into reset, a sensor left at 0x29 would answer with the next
+    conf.pin_bit_mask = 0;
+    for (int i = 0; i < Count; i++)
+        conf.pin_bit_mask |= 1ULL << pXshut[i];
+    conf.mode = GPIO_MODE_OUTPUT;
+    conf.pull_up_en = GPIO_PULLUP_DISABLE;
+    conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    conf.intr_type = GPIO_INTR_DISABLE;
+    if (gpio_config(&conf) != ESP_OK)
+        return VL53L0X_ERROR_CONTROL_INTERFACE;
+    for (int i = 0; i < Count; i++)
+        gpio_set_level(pXshut[i], 0);
+    vTaskDelay(XSHUT_RESET_MS / portTICK_RATE_MS + 1);
+
+    for (int i = 0; i < Count && Status == VL53L0X_ERROR_NONE; i++) {
+        VL53L0X_BusSensor_t *sensor = &pBus->Sensors[i];
+        VL53L0X_DEV Dev = &sensor->Dev;
+
+        sensor->Xshut = pXshut[i];
+        Dev->i2c_port_num = Port;
+        Dev->i2c_address = VL53L0X_DEFAULT_ADDRESS;
+
+        xshut_set(sensor->Xshut, 1, XSHUT_BOOT_MS);
+
+        // takes the 8 bit form of the address
+        Status = VL53L0X_SetDeviceAddress(Dev, (FirstAddress + i) << 1);
+        if (Status != VL53L0X_ERROR_NONE) {
+            gpio_set_level(sensor->Xshut, 0);
+            break;
+        }
+        Dev->i2c_address = FirstAddress + i;
+        pBus->Count++;
+    }
+
+    return Status;
+}
+
+VL53L0X_Error VL53L0X_BusStartRanging(VL53L0X_Bus_t *pBus, uint32_t PeriodMs,
+    UBaseType_t Priority)
+{
+    VL53L0X_Error Status = VL53L0X_ERROR_NONE;
+    TickType_t stagger;
+
+    if (pBus->Count == 0)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+    stagger = PeriodMs / pBus->Count / portTICK_RATE_MS;
+
+    for (int i = 0; i < pBus->Count; i++) {
+        VL53L0X_BusSensor_t *sensor = &pBus->Sensors[i];
+
+        if (i > 0 && stagger > 0)
+            vTaskDelay(stagger);
+
+        Status = VL53L0X_StartRangingService(&sensor->Ranging, &sensor->Dev,
+            PeriodMs, Priority);
+        if (Status != VL53L0X_ERROR_NONE)
+            break;
+        if (i == 0)
+            pBus->StartUs = esp_timer_get_time();
+        pBus->Ranging++;
+    }
+
+    if (Status != VL53L0X_ERROR_NONE)
+        VL53L0X_BusStopRanging(pBus);
+
+    return Status;
+}
+
+VL53L0X_Error VL53L0X_BusStopRanging(VL53L0X_Bus_t *pBus)
+{
+    for (int i = 0; i < pBus->Ranging; i++)
+        VL53L0X_StopRangingService(&pBus->Sensors[i].Ranging);
+    pBus->Ranging = 0;
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_BusGetSampleRate(const VL53L0X_Bus_t *pBus,
+    FixPoint1616_t *pRate)
+{
+    // in 64 us units, 10^6 / 64 = 15625: no overflow for any sample count
+    // the services can publish
+    uint64_t elapsed = (uint64_t)(esp_timer_get_time() - pBus->StartUs) / 64;
+    uint64_t samples = 0;
+
+    if (pBus->Ranging == 0 || elapsed == 0)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    for (int i = 0; i < pBus->Ranging; i++)
+        samples += VL53L0X_GetRangingCount(&pBus->Sensors[i].Ranging);
+
+    *pRate = (FixPoint1616_t)((samples << 16) * 15625 / elapsed);
+    return VL53L0X_ERROR_NONE;
+}
+
+#endif /* VL53L0X_PLATFORM_SIM */
@@ -0,0 +1,545 @@
+#include "vl53l0x_i2c_platform.h"
+
+#ifndef VL53L0X_PLATFORM_SIM
+
+#include <string.h>
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+
+#define ACK_CHECK_EN true
+
+// slack on top of the expected measurement time before falling back to a poll
+#define GPIO1_TIMEOUT_MARGIN_MS 10
+
+/*
+ * Command links are built in a static buffer per I2C port instead of being
+ * allocated and freed for every register access. A batched write needs
+ * start + address + index + payload per register write, plus the final stop.
+ * Older IDF releases have no static links, fall back to the heap there.
+ */
+#ifdef I2C_LINK_RECOMMENDED_SIZE
+#define VL53L0X_CMD_LINK_SIZE I2C_LINK_RECOMMENDED_SIZE(4 * VL53L0X_WRITE_BATCH_SIZE + 1)
+
+static uint8_t cmd_link_buffer[I2C_NUM_MAX][VL53L0X_CMD_LINK_SIZE];
+
+static i2c_cmd_handle_t cmd_link_create(i2c_port_t port)
+{
+    return i2c_cmd_link_create_static(cmd_link_buffer[port], VL53L0X_CMD_LINK_SIZE);
+}
+
+static void cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+    i2c_cmd_link_delete_static(cmd);
+}
+#else
+static i2c_cmd_handle_t cmd_link_create(i2c_port_t port)
+{
+    return i2c_cmd_link_create();
+}
+
+static void cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+    i2c_cmd_link_delete(cmd);
+}
+#endif
+
+// one mutex per port, shared by all devices on it
+static SemaphoreHandle_t bus_mutex[I2C_NUM_MAX];
+
+// what VL53L0X_I2cInit() was given, to install the driver again
+typedef struct {
+    gpio_num_t  Sda;
+    gpio_num_t  Scl;
+    uint32_t    ClockHz;                  /*!< 0 until VL53L0X_I2cInit() */
+    uint8_t     Installed;
+} VL53L0X_I2cPort_t;
+
+static VL53L0X_I2cPort_t bus_port[I2C_NUM_MAX];
+
+// result of the last transaction per port, for VL53L0X_i2c_recover()
+static esp_err_t bus_error[I2C_NUM_MAX];
+
+VL53L0X_Error esp_to_vl53l0x_error(esp_err_t esp_err) {
+    switch (esp_err) {
+        case ESP_OK:
+            return VL53L0X_ERROR_NONE;
+        case ESP_ERR_INVALID_ARG:
+            return VL53L0X_ERROR_INVALID_PARAMS;
+        case ESP_FAIL:
+        case ESP_ERR_INVALID_STATE:
+            return VL53L0X_ERROR_CONTROL_INTERFACE;
+        case ESP_ERR_TIMEOUT:
+            return VL53L0X_ERROR_TIME_OUT;
+        default:
+            return VL53L0X_ERROR_UNDEFINED;
+    }
+}
+
+/**
+ * Send register writes as a single bus transaction, separated by repeated starts
+ * @param   Dev       Device Handle
+ * @param   pWrites   Register writes to send, in order
+ * @param   count     Number of entries in pWrites
+ * @param   timeoutMs Longest the transaction may take
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_i2c_write(VL53L0X_DEV Dev, const VL53L0X_I2cWrite_t *pWrites, uint8_t count,
+    uint32_t timeoutMs)
+{
+    i2c_cmd_handle_t cmd = cmd_link_create(Dev->i2c_port_num);
+    esp_err_t ret = cmd == NULL ? ESP_ERR_NO_MEM : ESP_OK;
+
+    for (int i = 0; i < count && ret == ESP_OK; i++)
+    {
+        ret = i2c_master_start(cmd);
+
+        // write I2C address
+        if (ret == ESP_OK)
+            ret = i2c_master_write_byte(cmd, ( Dev->i2c_address << 1 ) | I2C_MASTER_WRITE, ACK_CHECK_EN);
+
+        // write register
+        if (ret == ESP_OK)
+            ret = i2c_master_write_byte(cmd, pWrites[i].Index, ACK_CHECK_EN);
+
+        // Data, the whole payload in one command. The driver still checks
+        // the ack of every byte.
+        if (ret == ESP_OK && pWrites[i].Count > 0)
+            ret = i2c_master_write(cmd, pWrites[i].pData, pWrites[i].Count, ACK_CHECK_EN);
+    }
+
+    if (ret == ESP_OK)
+        ret = i2c_master_stop(cmd);
+    if (ret == ESP_OK)
+        ret = i2c_master_cmd_begin(Dev->i2c_port_num, cmd, timeoutMs / portTICK_RATE_MS + 1);
+    if (cmd != NULL)
+        cmd_link_delete(cmd);
+
+    bus_error[Dev->i2c_port_num] = ret;
+    return esp_to_vl53l0x_error(ret);
+}
+
+/**
+ * Read consecutive registers in a single bus transaction
+ * @param   Dev       Device Handle
+ * @param   index     The register index
+ * @param   pdata     Pointer to the uint8_t buffer to store read data
+ * @param   count     Number of uint8_t's to read
+ * @param   timeoutMs Longest the transaction may take
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_i2c_read(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count,
+    uint32_t timeoutMs)
+{
+    // I2C write
+    i2c_cmd_handle_t cmd = cmd_link_create(Dev->i2c_port_num);
+    esp_err_t ret = cmd == NULL ? ESP_ERR_NO_MEM : ESP_OK;
+
+    ////// First tell the VL53L0X which register we are reading from
+    if (ret == ESP_OK)
+        ret = i2c_master_start(cmd);
+
+    // Write I2C address
+    if (ret == ESP_OK)
+        ret = i2c_master_write_byte(cmd, ( Dev->i2c_address << 1 ) | I2C_MASTER_WRITE, ACK_CHECK_EN);
+    // Write register
+    if (ret == ESP_OK)
+        ret = i2c_master_write_byte(cmd, index, ACK_CHECK_EN);
+
+    ////// Second, read from the register
+    if (ret == ESP_OK)
+        ret = i2c_master_start(cmd);
+
+    // Write I2C address
+    if (ret == ESP_OK)
+        ret = i2c_master_write_byte(cmd, ( Dev->i2c_address << 1 ) | I2C_MASTER_READ, ACK_CHECK_EN);
+
+    // Read data from register
+    if (ret == ESP_OK)
+        ret = i2c_master_read(cmd, pdata, count, I2C_MASTER_LAST_NACK);
+
+    if (ret == ESP_OK)
+        ret = i2c_master_stop(cmd);
+    if (ret == ESP_OK)
+        ret = i2c_master_cmd_begin(Dev->i2c_port_num, cmd, timeoutMs / portTICK_RATE_MS + 1);
+    if (cmd != NULL)
+        cmd_link_delete(cmd);
+
+    bus_error[Dev->i2c_port_num] = ret;
+    return esp_to_vl53l0x_error(ret);
+}
+
+// busy wait, a quarter of an SCL period is far below a tick
+static void bus_delay_us(uint32_t us)
+{
+    int64_t end = esp_timer_get_time() + us;
+
+    while (esp_timer_get_time() < end)
+        ;
+}
+
+static int bus_line_low(gpio_num_t pin)
+{
+    return gpio_get_level(pin) == 0;
+}
+
+static esp_err_t bus_install(i2c_port_t port)
+{
+    const VL53L0X_I2cPort_t *bus = &bus_port[port];
+    i2c_config_t conf;
+    esp_err_t ret;
+
+    memset(&conf, 0, sizeof(conf));
+    conf.mode = I2C_MODE_MASTER;
+    conf.sda_io_num = bus->Sda;
+    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.scl_io_num = bus->Scl;
+    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.master.clk_speed = bus->ClockHz;
+    ret = i2c_param_config(port, &conf);
+    if (ret == ESP_OK)
+        ret = i2c_driver_install(port, conf.mode, 0, 0, 0);
+    return ret;
+}
+
+VL53L0X_Error VL53L0X_I2cInit(i2c_port_t Port, gpio_num_t Sda, gpio_num_t Scl,
+    uint32_t ClockHz)
+{
+    if (Port >= I2C_NUM_MAX)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    bus_port[Port].Sda = Sda;
+    bus_port[Port].Scl = Scl;
+    bus_port[Port].ClockHz = ClockHz;
+    bus_port[Port].Installed = bus_install(Port) == ESP_OK;
+
+    return bus_port[Port].Installed ? VL53L0X_ERROR_NONE :
+        VL53L0X_ERROR_CONTROL_INTERFACE;
+}
+
+/*
+ * A slave reset or disturbed in the middle of a read keeps driving SDA low
+ * until it has clocked out the rest of its byte. Up to nine SCL pulses by
+ * hand release it, then a STOP puts every slave back to idle.
+ */
+uint8_t VL53L0X_i2c_recover(VL53L0X_DEV Dev)
+{
+    i2c_port_t port = Dev->i2c_port_num;
+    VL53L0X_I2cPort_t *bus = &bus_port[port];
+    uint32_t half = 500000 / bus->ClockHz + 1;
+    esp_err_t error = bus_error[port];
+    uint8_t result = VL53L0X_I2C_RECOVER_DRIVER;
+    int pulses;
+
+    // a NACK leaves a healthy bus behind, and VL53L0X_I2cInit() was never called
+    if (bus->ClockHz == 0 || (error != ESP_ERR_TIMEOUT &&
+            error != ESP_ERR_INVALID_STATE && bus->Installed &&
+            !bus_line_low(bus->Sda) && !bus_line_low(bus->Scl)))
+        return VL53L0X_I2C_RECOVER_NONE;
+
+    if (bus->Installed)
+        i2c_driver_delete(port);
+    bus->Installed = 0;
+
+    gpio_set_level(bus->Sda, 1);
+    gpio_set_level(bus->Scl, 1);
+    gpio_set_direction(bus->Sda, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_direction(bus->Scl, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode(bus->Sda, GPIO_PULLUP_ONLY);
+    gpio_set_pull_mode(bus->Scl, GPIO_PULLUP_ONLY);
+    bus_delay_us(half);
+
+    if (bus_line_low(bus->Sda))
+        result |= VL53L0X_I2C_RECOVER_SDA;
+    for (pulses = 0; pulses < 9 && bus_line_low(bus->Sda); pulses++) {
+        gpio_set_level(bus->Scl, 0);
+        bus_delay_us(half);
+        gpio_set_level(bus->Scl, 1);
+        bus_delay_us(half);
+    }
+
+    // STOP: SDA rises while SCL is high
+    gpio_set_level(bus->Sda, 0);
+    bus_delay_us(half);
+    gpio_set_level(bus->Scl, 1);
+    bus_delay_us(half);
+    gpio_set_level(bus->Sda, 1);
+    bus_delay_us(half);
+
+    if (bus_line_low(bus->Sda) || bus_line_low(bus->Scl))
+        result |= VL53L0X_I2C_RECOVER_FAILED;
+
+    bus->Installed = bus_install(port) == ESP_OK;
+    if (!bus->Installed)
+        result |= VL53L0X_I2C_RECOVER_FAILED;
+
+    return result;
+}
+
+uint8_t VL53L0X_i2c_lock(VL53L0X_DEV Dev, uint8_t wait)
+{
+    SemaphoreHandle_t mutex = bus_mutex[Dev->i2c_port_num];
+
+    if (mutex == NULL)
+        return 1;
+    return xSemaphoreTake(mutex, wait ? portMAX_DELAY : 0) == pdTRUE;
+}
+
+void VL53L0X_i2c_unlock(VL53L0X_DEV Dev)
+{
+    SemaphoreHandle_t mutex = bus_mutex[Dev->i2c_port_num];
+
+    if (mutex != NULL)
+        xSemaphoreGive(mutex);
+}
+
+VL53L0X_Error VL53L0X_CreateLocks(VL53L0X_DEV Dev)
+{
+    if (bus_mutex[Dev->i2c_port_num] == NULL)
+        bus_mutex[Dev->i2c_port_num] = xSemaphoreCreateMutex();
+    if (Dev->lock == NULL)
+        Dev->lock = xSemaphoreCreateRecursiveMutex();
+
+    if (bus_mutex[Dev->i2c_port_num] == NULL || Dev->lock == NULL)
+        return VL53L0X_ERROR_UNDEFINED;
+    return VL53L0X_ERROR_NONE;
+}
+
+void VL53L0X_LockDevice(VL53L0X_DEV Dev)
+{
+    uint32_t start;
+
+    if (Dev->lock == NULL)
+        return;
+    if (xSemaphoreTakeRecursive(Dev->lock, 0) == pdTRUE)
+        return;
+
+    start = VL53L0X_GetTickCountUs();
+    xSemaphoreTakeRecursive(Dev->lock, portMAX_DELAY);
+    Dev->i2c_stats.DeviceWaits++;
+    Dev->i2c_stats.DeviceWaitUs += VL53L0X_GetTickCountUs() - start;
+}
+
+void VL53L0X_UnlockDevice(VL53L0X_DEV Dev)
+{
+    if (Dev->lock != NULL)
+        xSemaphoreGiveRecursive(Dev->lock);
+}
+
+uint32_t VL53L0X_GetTickCountUs(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+/*
+ * Send queued writes before waiting on the sensor, if the calling task holds
+ * the device lock. Only then can the writes be its own: the ranging task
+ * and VL53L0X_WaitInterrupt() callers wait unlocked with nothing queued,
+ * and must not send the half of a batch another task is building.
+ */
+static VL53L0X_Error flush_before_wait(VL53L0X_DEV Dev)
+{
+    if (Dev->lock != NULL &&
+            xSemaphoreGetMutexHolder(Dev->lock) != xTaskGetCurrentTaskHandle())
+        return VL53L0X_ERROR_NONE;
+    return VL53L0X_FlushWriteBatch(Dev);
+}
+
+/**
+ * @brief execute delay in all polling API call
+ *
+ * A typical multi-thread or RTOs implementation is to sleep the task for some 5ms (with 100Hz max rate faster polling is not needed)
+ * if nothing specific is need you can define it as an empty/void macro
+ * @code
+ * #define VL53L0X_PollingDelay(...) (void)0
+ * @endcode
+ * @param Dev       Device Handle
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  "Other error code"    See ::VL53L0X_Error
+ */
+VL53L0X_Error VL53L0X_PollingDelay(VL53L0X_DEV Dev)
+{
+    // queued writes must reach the device before we wait on it
+    VL53L0X_Error status = flush_before_wait(Dev);
+
+    // 1 ms between polls. A tick sleep only when a tick is that short: at
+    // CONFIG_FREERTOS_HZ=100 it would round every completion up to 10 ms,
+    // so the wait spins instead, other tasks still preempt it
+    if (portTICK_PERIOD_MS <= 1) {
+        vTaskDelay(1);
+    } else {
+        int64_t until = esp_timer_get_time() + 1000;
+
+        while (esp_timer_get_time() < until)
+            ;
+    }
+    return status;
+}
+
+static void IRAM_ATTR gpio1_isr(void *arg)
+{
+    VL53L0X_DEV Dev = (VL53L0X_DEV)arg;
+    TaskHandle_t task = Dev->gpio1.Task;
+    BaseType_t woken = pdFALSE;
+
+    Dev->gpio1.ReadyUs = (uint32_t)esp_timer_get_time();
+    // level triggered: would fire again until the sensor is cleared
+    if (Dev->gpio1.WakeUp)
+        gpio_intr_disable(Dev->gpio1.Pin);
+    if (task != NULL)
+        vTaskNotifyGiveFromISR(task, &woken);
+    if (woken == pdTRUE)
+        portYIELD_FROM_ISR();
+}
+
+VL53L0X_Error VL53L0X_SetInterruptPin(VL53L0X_DEV Dev, gpio_num_t Pin,
+    VL53L0X_InterruptPolarity Polarity)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+    gpio_config_t conf;
+    esp_err_t ret;
+
+    if (gpio1->Enabled) {
+        VL53L0X_SetInterruptWakeup(Dev, 0);
+        gpio_isr_handler_remove(gpio1->Pin);
+        gpio1->Enabled = 0;
+    }
+    if (Pin == GPIO_NUM_MAX)
+        return VL53L0X_ERROR_NONE;
+
+    gpio1->Pin = Pin;
+    gpio1->ActiveLevel = Polarity == VL53L0X_INTERRUPTPOLARITY_HIGH;
+    gpio1->Task = NULL;
+
+    // GPIO1 is open drain on most breakouts
+    conf.pin_bit_mask = 1ULL << Pin;
+    conf.mode = GPIO_MODE_INPUT;
+    conf.pull_up_en = gpio1->ActiveLevel ? GPIO_PULLUP_DISABLE : GPIO_PULLUP_ENABLE;
+    conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    conf.intr_type = gpio1->ActiveLevel ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE;
+    ret = gpio_config(&conf);
+    if (ret != ESP_OK)
+        return esp_to_vl53l0x_error(ret);
+
+    // already installed by someone else (camera driver) is fine
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+        return esp_to_vl53l0x_error(ret);
+
+    ret = gpio_isr_handler_add(Pin, gpio1_isr, Dev);
+    if (ret != ESP_OK)
+        return esp_to_vl53l0x_error(ret);
+
+    gpio1->Enabled = 1;
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_SetInterruptWakeup(VL53L0X_DEV Dev, uint8_t Enable)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+    esp_err_t ret;
+
+    if (!gpio1->Enabled)
+        return VL53L0X_ERROR_GPIO_NOT_EXISTING;
+    if (gpio1->WakeUp == !!Enable)
+        return VL53L0X_ERROR_NONE;
+
+    if (Enable) {
+        // masked until someone waits, the pin may well be active already
+        gpio_intr_disable(gpio1->Pin);
+        gpio1->WakeUp = 1;
+        ret = gpio_wakeup_enable(gpio1->Pin,
+            gpio1->ActiveLevel ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        if (ret == ESP_OK)
+            ret = esp_sleep_enable_gpio_wakeup();
+        if (ret == ESP_OK)
+            return VL53L0X_ERROR_NONE;
+    } else {
+        ret = ESP_OK;
+    }
+
+    // back to the edge interrupt of VL53L0X_SetInterruptPin()
+    gpio_wakeup_disable(gpio1->Pin);
+    gpio1->WakeUp = 0;
+    gpio_set_intr_type(gpio1->Pin,
+        gpio1->ActiveLevel ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+    gpio_intr_enable(gpio1->Pin);
+    return esp_to_vl53l0x_error(ret);
+}
+
+/*
+ * Block the calling task until GPIO1 is active or the timeout expires,
+ * true if it is active. Edges nobody waited for are dropped, then the task
+ * is published before looking at the pin so an edge in between leaves a
+ * notification behind.
+ */
+static int gpio1_wait(VL53L0X_Gpio1_t *gpio1, TickType_t timeout)
+{
+    int active = 1;
+
+    ulTaskNotifyTake(pdTRUE, 0);
+    gpio1->Task = xTaskGetCurrentTaskHandle();
+    if (gpio1->WakeUp)
+        gpio_intr_enable(gpio1->Pin);
+
+    if (gpio_get_level(gpio1->Pin) != gpio1->ActiveLevel) {
+        gpio1->Waits++;
+        active = ulTaskNotifyTake(pdTRUE, timeout) != 0;
+    }
+
+    gpio1->Task = NULL;
+    return active;
+}
+
+static TickType_t gpio1_timeout(VL53L0X_DEV Dev)
+{
+    VL53L0X_DeviceParameters_t *params = &PALDevDataGet(Dev, CurrentParameters);
+    uint32_t ms = params->MeasurementTimingBudgetMicroSeconds / 1000 + GPIO1_TIMEOUT_MARGIN_MS;
+
+    if (params->DeviceMode == VL53L0X_DEVICEMODE_CONTINUOUS_TIMED_RANGING)
+        ms += params->InterMeasurementPeriodMilliSeconds;
+
+    return ms / portTICK_RATE_MS + 1;
+}
+
+VL53L0X_Error VL53L0X_WaitDataReady(VL53L0X_DEV Dev)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+    VL53L0X_Error status;
+
+    if (!gpio1->Enabled)
+        return VL53L0X_PollingDelay(Dev);
+
+    // the measurement may be waiting for queued writes
+    status = flush_before_wait(Dev);
+
+    if (!gpio1_wait(gpio1, gpio1_timeout(Dev)))
+        gpio1->Timeouts++;
+
+    return status;
+}
+
+VL53L0X_Error VL53L0X_WaitInterrupt(VL53L0X_DEV Dev, uint32_t TimeoutMs)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+    VL53L0X_Error status;
+
+    if (!gpio1->Enabled)
+        return VL53L0X_ERROR_GPIO_NOT_EXISTING;
+
+    status = flush_before_wait(Dev);
+    if (status != VL53L0X_ERROR_NONE)
+        return status;
+
+    if (!gpio1_wait(gpio1, TimeoutMs == VL53L0X_WAIT_FOREVER ? portMAX_DELAY :
+            TimeoutMs / portTICK_RATE_MS + 1))
+        return VL53L0X_ERROR_TIME_OUT;
+    return VL53L0X_ERROR_NONE;
+}
+
+#endif /* VL53L0X_PLATFORM_SIM */
@@ -0,0 +1,531 @@
+#include "vl53l0x_i2c_platform.h"
+
+#ifdef VL53L0X_PLATFORM_SIM
+
+// VHV and phase calibration measurements, much shorter than a range
+#define SIM_CALIBRATION_US      1000
+
+// what VL53L0X_PollingDelay() costs on the target, 1 ms whatever the
+// CONFIG_FREERTOS_HZ
+#define SIM_POLLING_DELAY_US    1000
+
+#define SIM_PAGE_NVM            7
+
+static VL53L0X_SimDevice_t *sim_bus[VL53L0X_SIM_PORTS][VL53L0X_SIM_DEVICES];
+static uint32_t sim_time_us;
+static uint32_t sim_clock_hz = 400000;
+static uint32_t sim_transaction_us = 50;
+
+static void sim_wr16(uint8_t *regs, uint8_t index, uint16_t value)
+{
+    regs[index] = value >> 8;
+    regs[index + 1] = value & 0xFF;
+}
+
+static uint16_t sim_rd16(const uint8_t *regs, uint8_t index)
+{
+    return (regs[index] << 8) | regs[index + 1];
+}
+
+static uint32_t sim_rd32(const uint8_t *regs, uint8_t index)
+{
+    return ((uint32_t)sim_rd16(regs, index) << 16) | sim_rd16(regs, index + 2);
+}
+
+// product id: 7 bit characters packed MSB first into NVM words 0x77..0x7A
+static void sim_nvm_product_id(VL53L0X_SimDevice_t *pSim, const char *id)
+{
+    for (int i = 0; id[i] != '\0' && i < 18; i++) {
+        for (int bit = 0; bit < 7; bit++) {
+            int pos = i * 7 + bit;
+            uint32_t mask = 0x80000000u >> (pos % 32);
+
+            if (id[i] & (0x40 >> bit))
+                pSim->Nvm[0x77 + pos / 32] |= mask;
+        }
+    }
+}
+
+static void sim_power_on(VL53L0X_SimDevice_t *pSim)
+{
+    uint8_t *regs = pSim->Regs[0];
+
+    memset(pSim->Regs, 0, sizeof(pSim->Regs));
+    pSim->Page = 0;
+    pSim->Ranging = 0;
+    pSim->Continuous = 0;
+
+    regs[VL53L0X_REG_SOFT_RESET_GO2_SOFT_RESET_N] = 0x01;
+    regs[VL53L0X_REG_IDENTIFICATION_MODEL_ID] = 0xEE;
+    regs[VL53L0X_REG_IDENTIFICATION_MODEL_ID + 1] = 0xAA;
+    regs[VL53L0X_REG_IDENTIFICATION_REVISION_ID] = 0x10;
+    regs[VL53L0X_REG_PRE_RANGE_CONFIG_VCSEL_PERIOD] = 0x06;
+    regs[VL53L0X_REG_FINAL_RANGE_CONFIG_VCSEL_PERIOD] = 0x04;
+    regs[VL53L0X_REG_MSRC_CONFIG_TIMEOUT_MACROP] = 0x0C;
+    sim_wr16(regs, VL53L0X_REG_PRE_RANGE_CONFIG_TIMEOUT_MACROP_HI, 0x0145);
+    sim_wr16(regs, VL53L0X_REG_FINAL_RANGE_CONFIG_TIMEOUT_MACROP_HI, 0x02B9);
+    regs[VL53L0X_REG_SYSTEM_SEQUENCE_CONFIG] = 0xFF;
+    regs[VL53L0X_REG_GPIO_HV_MUX_ACTIVE_HIGH] = 0x11;
+    regs[VL53L0X_REG_SYSTEM_INTERRUPT_CONFIG_GPIO] = VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_NEW_SAMPLE_READY;
+
+    // stop variable, read back by VL53L0X_DataInit()
+    pSim->Regs[1][0x91] = 0x3C;
+}
+
+void VL53L0X_SimReset(VL53L0X_SimDevice_t *pSim)
+{
+    memset(pSim, 0, sizeof(*pSim));
+    pSim->Enabled = 1;
+    pSim->Address = 0x29;
+    pSim->MeasurementUs = 33000;
+    pSim->RefSpadSignalRate = 0x01C0; // 3.5 MCPS, about 6 SPADs to reach 20
+    pSim->DefaultRange.RangeMilliMeter = 500;
+    pSim->DefaultRange.DeviceRangeStatus = 11;
+    pSim->DefaultRange.SignalRateRtn = 10 << 7;
+    pSim->DefaultRange.AmbientRateRtn = 1 << 5;
+    pSim->DefaultRange.EffectiveSpadRtnCount = 8 << 8;
+
+    // reference SPADs: 5 aperture SPADs, all 48 good
+    pSim->Nvm[0x6B] = (1 << 15) | (5 << 8);
+    pSim->Nvm[0x24] = 0xFFFFFFFF;
+    pSim->Nvm[0x25] = 0xFFFF0000;
+    pSim->Nvm[0x02] = 0x01000000;     // module id
+    sim_nvm_product_id(pSim, "VL53L0CBV0DH/1$1");
+    pSim->Nvm[0x7B] |= 0x10000000;    // revision (top byte), part UID upper
+    pSim->Nvm[0x7C] = 0x5EED0001;     // part UID lower
+
+    sim_power_on(pSim);
+}
+
+int VL53L0X_SimAttach(i2c_port_t Port, VL53L0X_SimDevice_t *pSim)
+{
+    for (int i = 0; i < VL53L0X_SIM_DEVICES; i++) {
+        if (sim_bus[Port][i] == NULL) {
+            sim_bus[Port][i] = pSim;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void VL53L0X_SimDetachAll(void)
+{
+    memset(sim_bus, 0, sizeof(sim_bus));
+    sim_time_us = 0;
+}
+
+void VL53L0X_SimSetBusTiming(uint32_t ClockHz, uint32_t TransactionUs)
+{
+    sim_clock_hz = ClockHz;
+    sim_transaction_us = TransactionUs;
+}
+
+void VL53L0X_SimAdvance(uint32_t Us)
+{
+    sim_time_us += Us;
+}
+
+static VL53L0X_SimDevice_t *sim_find(VL53L0X_DEV Dev)
+{
+    if (Dev->i2c_port_num < 0 || Dev->i2c_port_num >= VL53L0X_SIM_PORTS)
+        return NULL;
+
+    for (int i = 0; i < VL53L0X_SIM_DEVICES; i++) {
+        VL53L0X_SimDevice_t *sim = sim_bus[Dev->i2c_port_num][i];
+
+        if (sim != NULL && sim->Enabled && sim->Address == Dev->i2c_address)
+            return sim;
+    }
+    return NULL;
+}
+
+// bits on the wire to microseconds, plus the fixed per transaction cost
+static uint32_t sim_bus_time(uint32_t bits)
+{
+    return (uint32_t)(((uint64_t)bits * 1000000 + sim_clock_hz - 1) / sim_clock_hz) + sim_transaction_us;
+}
+
+static void sim_start_ranging(VL53L0X_SimDevice_t *pSim, uint32_t start)
+{
+    uint8_t sequence = pSim->Regs[0][VL53L0X_REG_SYSTEM_SEQUENCE_CONFIG];
+
+    pSim->Ranging = 1;
+    pSim->StartUs = start;
+    if (sequence == 0x01 || sequence == 0x02)
+        pSim->ReadyUs = start + SIM_CALIBRATION_US;
+    else
+        pSim->ReadyUs = start + pSim->MeasurementUs;
+}
+
+static uint8_t sim_interrupt(VL53L0X_SimDevice_t *pSim, uint16_t range)
+{
+    uint8_t *regs = pSim->Regs[0];
+    uint8_t config = regs[VL53L0X_REG_SYSTEM_INTERRUPT_CONFIG_GPIO] & 0x07;
+    // thresholds are stored in units of 2 mm
+    uint16_t high = sim_rd16(regs, VL53L0X_REG_SYSTEM_THRESH_HIGH) * 2;
+    uint16_t low = sim_rd16(regs, VL53L0X_REG_SYSTEM_THRESH_LOW) * 2;
+
+    switch (config) {
+    case VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_LEVEL_LOW:
+        return range < low ? config : 0;
+    case VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_LEVEL_HIGH:
+        return range > high ? config : 0;
+    case VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_OUT_OF_WINDOW:
+        return range < low || range > high ? config : 0;
+    default:
+        return VL53L0X_REG_SYSTEM_INTERRUPT_GPIO_NEW_SAMPLE_READY;
+    }
+}
+
+static uint32_t sim_ref_spads(VL53L0X_SimDevice_t *pSim)
+{
+    uint32_t count = 0;
+
+    for (int i = 0; i < 6; i++)
+        count += __builtin_popcount(pSim->Regs[0][VL53L0X_REG_GLOBAL_CONFIG_SPAD_ENABLES_REF_0 + i]);
+    return count;
+}
+
+static void sim_complete(VL53L0X_SimDevice_t *pSim)
+{
+    uint8_t *regs = pSim->Regs[0];
+    const VL53L0X_SimRange_t *range = &pSim->DefaultRange;
+    uint32_t period;
+
+    if (pSim->pScript != NULL && pSim->ScriptLength > 0)
+        range = &pSim->pScript[pSim->Measurements % pSim->ScriptLength];
+    pSim->Measurements++;
+
+    regs[VL53L0X_REG_RESULT_RANGE_STATUS] = (range->DeviceRangeStatus << 3) | 0x01;
+    sim_wr16(regs, VL53L0X_REG_RESULT_RANGE_STATUS + 2, range->EffectiveSpadRtnCount);
+    sim_wr16(regs, VL53L0X_REG_RESULT_RANGE_STATUS + 6, range->SignalRateRtn);
+    sim_wr16(regs, VL53L0X_REG_RESULT_RANGE_STATUS + 8, range->AmbientRateRtn);
+    sim_wr16(regs, VL53L0X_REG_RESULT_RANGE_STATUS + 10, range->RangeMilliMeter);
+    sim_wr16(pSim->Regs[VL53L0X_REG_RESULT_CORE_PAGE], VL53L0X_REG_RESULT_PEAK_SIGNAL_RATE_REF,
+        sim_ref_spads(pSim) * pSim->RefSpadSignalRate);
+
+    // the interrupt stays pending until cleared, later results are lost
+    if (regs[VL53L0X_REG_RESULT_INTERRUPT_STATUS] == 0) {
+        regs[VL53L0X_REG_RESULT_INTERRUPT_STATUS] = sim_interrupt(pSim, range->RangeMilliMeter);
+        if (regs[VL53L0X_REG_RESULT_INTERRUPT_STATUS] != 0)
+            pSim->InterruptUs = pSim->ReadyUs;
+    }
+
+    pSim->Ranging = 0;
+    if (!pSim->Continuous)
+        return;
+
+    // timed mode: period in ms, scaled by the oscillator calibration if set
+    period = sim_rd32(regs, VL53L0X_REG_SYSTEM_INTERMEASUREMENT_PERIOD);
+    if (sim_rd16(regs, VL53L0X_REG_OSC_CALIBRATE_VAL) != 0)
+        period /= sim_rd16(regs, VL53L0X_REG_OSC_CALIBRATE_VAL);
+    if (regs[VL53L0X_REG_SYSRANGE_START] & VL53L0X_REG_SYSRANGE_MODE_TIMED &&
+            pSim->StartUs + period * 1000 > pSim->ReadyUs)
+        sim_start_ranging(pSim, pSim->StartUs + period * 1000);
+    else
+        sim_start_ranging(pSim, pSim->ReadyUs);
+}
+
+// bring the model up to the simulated time, the ISR of the target has
+// seen any interrupt by then
+static void sim_update(VL53L0X_DEV Dev, VL53L0X_SimDevice_t *pSim)
+{
+    while (pSim->Ranging && (int32_t)(sim_time_us - pSim->ReadyUs) >= 0)
+        sim_complete(pSim);
+    Dev->gpio1.ReadyUs = pSim->InterruptUs;
+}
+
+static void sim_write_byte(VL53L0X_SimDevice_t *pSim, uint8_t index, uint8_t value)
+{
+    uint8_t *regs = pSim->Regs[pSim->Page];
+
+    // page select and power control are visible from every page
+    if (index == 0xFF) {
+        pSim->Page = value % VL53L0X_SIM_PAGES;
+        return;
+    }
+    if (index == VL53L0X_REG_POWER_MANAGEMENT_GO1_POWER_FORCE) {
+        pSim->Regs[0][index] = value;
+        return;
+    }
+
+    if (pSim->Page == SIM_PAGE_NVM && index == 0x83 && value == 0x00) {
+        // strobe: latch the NVM word selected by 0x94 into 0x90..0x93
+        uint32_t word = pSim->Nvm[regs[0x94] % 128];
+
+        sim_wr16(regs, 0x90, word >> 16);
+        sim_wr16(regs, 0x92, word & 0xFFFF);
+        regs[0x83] = 0x01;
+        return;
+    }
+
+    if (pSim->Page != 0) {
+        regs[index] = value;
+        return;
+    }
+
+    switch (index) {
+    case VL53L0X_REG_SYSRANGE_START:
+        // the API starts the continuous modes without the start bit
+        if (value & (VL53L0X_REG_SYSRANGE_MODE_START_STOP |
+                VL53L0X_REG_SYSRANGE_MODE_BACKTOBACK |
+                VL53L0X_REG_SYSRANGE_MODE_TIMED)) {
+            pSim->Continuous = (value & (VL53L0X_REG_SYSRANGE_MODE_BACKTOBACK |
+                VL53L0X_REG_SYSRANGE_MODE_TIMED)) != 0;
+            sim_start_ranging(pSim, sim_time_us);
+        } else {
+            pSim->Continuous = 0;
+            pSim->Ranging = 0;
+        }
+        // the start bit clears once the sequencer has picked it up
+        regs[index] = value & ~VL53L0X_REG_SYSRANGE_MODE_START_STOP;
+        break;
+    case VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR:
+        if (value != 0 && pSim->DropClears > 0) {
+            pSim->DropClears--;
+        } else if (value != 0) {
+            regs[VL53L0X_REG_RESULT_INTERRUPT_STATUS] = 0;
+            regs[VL53L0X_REG_RESULT_RANGE_STATUS] &= ~0x01;
+        }
+        regs[index] = value;
+        break;
+    case VL53L0X_REG_I2C_SLAVE_DEVICE_ADDRESS:
+        // takes effect from the next transaction
+        pSim->Address = value & 0x7F;
+        regs[index] = value;
+        break;
+    case VL53L0X_REG_SOFT_RESET_GO2_SOFT_RESET_N:
+        if (value == 0x00) {
+            sim_power_on(pSim);
+            // the model id reads 0 while the device is held in reset
+            regs[VL53L0X_REG_IDENTIFICATION_MODEL_ID] = 0x00;
+        } else {
+            regs[VL53L0X_REG_IDENTIFICATION_MODEL_ID] = 0xEE;
+        }
+        regs[index] = value;
+        break;
+    default:
+        regs[index] = value;
+        break;
+    }
+}
+
+static uint8_t sim_read_byte(VL53L0X_SimDevice_t *pSim, uint8_t index)
+{
+    if (index == 0xFF)
+        return pSim->Page;
+    if (index == VL53L0X_REG_POWER_MANAGEMENT_GO1_POWER_FORCE)
+        return pSim->Regs[0][index];
+    return pSim->Regs[pSim->Page][index];
+}
+
+/**
+ * Send register writes as a single bus transaction, separated by repeated starts
+ * @param   Dev       Device Handle
+ * @param   pWrites   Register writes to send, in order
+ * @param   count     Number of entries in pWrites
+ * @param   timeoutMs Longest the transaction may take
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_CONTROL_INTERFACE  No simulated sensor at the address
+ */
+VL53L0X_Error VL53L0X_i2c_write(VL53L0X_DEV Dev, const VL53L0X_I2cWrite_t *pWrites, uint8_t count,
+    uint32_t timeoutMs)
+{
+    VL53L0X_SimDevice_t *sim = sim_find(Dev);
+    uint32_t bits = 2;  // start, stop
+    uint32_t elapsed;
+
+    for (int i = 0; i < count; i++)
+        bits += 1 + 9 * (2 + pWrites[i].Count);  // (repeated) start, address, index, payload
+    elapsed = sim_bus_time(bits);
+    // the driver gives up on a slow transaction, the device may still get it
+    if (elapsed > timeoutMs * 1000) {
+        sim_time_us += timeoutMs * 1000;
+        return VL53L0X_ERROR_TIME_OUT;
+    }
+    sim_time_us += elapsed;
+
+    if (sim == NULL)
+        return VL53L0X_ERROR_CONTROL_INTERFACE;
+
+    sim_update(Dev, sim);
+    sim->Transactions++;
+    sim->BusTimeUs += elapsed;
+
+    for (int i = 0; i < count; i++) {
+        for (uint32_t j = 0; j < pWrites[i].Count; j++)
+            sim_write_byte(sim, pWrites[i].Index + j, pWrites[i].pData[j]);
+    }
+
+    return VL53L0X_ERROR_NONE;
+}
+
+/**
+ * Read consecutive registers in a single bus transaction
+ * @param   Dev       Device Handle
+ * @param   index     The register index
+ * @param   pdata     Pointer to the uint8_t buffer to store read data
+ * @param   count     Number of uint8_t's to read
+ * @param   timeoutMs Longest the transaction may take
+ * @return  VL53L0X_ERROR_NONE        Success
+ * @return  VL53L0X_ERROR_CONTROL_INTERFACE  No simulated sensor at the address
+ */
+VL53L0X_Error VL53L0X_i2c_read(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count,
+    uint32_t timeoutMs)
+{
+    VL53L0X_SimDevice_t *sim = sim_find(Dev);
+    // start, address, index, repeated start, address, data, stop
+    uint32_t elapsed = sim_bus_time(1 + 9 + 9 + 1 + 9 + 9 * count + 1);
+
+    if (elapsed > timeoutMs * 1000) {
+        sim_time_us += timeoutMs * 1000;
+        return VL53L0X_ERROR_TIME_OUT;
+    }
+    sim_time_us += elapsed;
+
+    if (sim == NULL)
+        return VL53L0X_ERROR_CONTROL_INTERFACE;
+
+    sim_update(Dev, sim);
+    sim->Transactions++;
+    sim->BusTimeUs += elapsed;
+
+    for (uint32_t i = 0; i < count; i++)
+        pdata[i] = sim_read_byte(sim, index + i);
+
+    return VL53L0X_ERROR_NONE;
+}
+
+// single threaded, nothing to lock
+uint8_t VL53L0X_i2c_lock(VL53L0X_DEV Dev, uint8_t wait)
+{
+    return 1;
+}
+
+void VL53L0X_i2c_unlock(VL53L0X_DEV Dev)
+{
+}
+
+// the model only ever NACKs, the bus itself never hangs
+uint8_t VL53L0X_i2c_recover(VL53L0X_DEV Dev)
+{
+    return VL53L0X_I2C_RECOVER_NONE;
+}
+
+VL53L0X_Error VL53L0X_I2cInit(i2c_port_t Port, gpio_num_t Sda, gpio_num_t Scl,
+    uint32_t ClockHz)
+{
+    return Port < VL53L0X_SIM_PORTS ? VL53L0X_ERROR_NONE :
+        VL53L0X_ERROR_INVALID_PARAMS;
+}
+
+VL53L0X_Error VL53L0X_CreateLocks(VL53L0X_DEV Dev)
+{
+    return VL53L0X_ERROR_NONE;
+}
+
+void VL53L0X_LockDevice(VL53L0X_DEV Dev)
+{
+}
+
+void VL53L0X_UnlockDevice(VL53L0X_DEV Dev)
+{
+}
+
+uint32_t VL53L0X_GetTickCountUs(void)
+{
+    return sim_time_us;
+}
+
+VL53L0X_Error VL53L0X_PollingDelay(VL53L0X_DEV Dev)
+{
+    VL53L0X_Error status = VL53L0X_FlushWriteBatch(Dev);
+
+    sim_time_us += SIM_POLLING_DELAY_US;
+    return status;
+}
+
+VL53L0X_Error VL53L0X_SetInterruptPin(VL53L0X_DEV Dev, gpio_num_t Pin,
+    VL53L0X_InterruptPolarity Polarity)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+
+    // no pin to configure, the interrupt comes straight from the model
+    gpio1->Enabled = Pin != GPIO_NUM_MAX;
+    gpio1->Pin = Pin;
+    gpio1->ActiveLevel = Polarity == VL53L0X_INTERRUPTPOLARITY_HIGH;
+    gpio1->Task = NULL;
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_SetInterruptWakeup(VL53L0X_DEV Dev, uint8_t Enable)
+{
+    if (!Dev->gpio1.Enabled)
+        return VL53L0X_ERROR_GPIO_NOT_EXISTING;
+
+    // the host never sleeps, waits behave the same either way
+    Dev->gpio1.WakeUp = Enable != 0;
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_WaitInterrupt(VL53L0X_DEV Dev, uint32_t TimeoutMs)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+    VL53L0X_SimDevice_t *sim;
+    uint32_t deadline = sim_time_us + TimeoutMs * 1000;
+    VL53L0X_Error status;
+
+    if (!gpio1->Enabled)
+        return VL53L0X_ERROR_GPIO_NOT_EXISTING;
+
+    status = VL53L0X_FlushWriteBatch(Dev);
+    sim = sim_find(Dev);
+    if (status != VL53L0X_ERROR_NONE || sim == NULL)
+        return status != VL53L0X_ERROR_NONE ? status : VL53L0X_ERROR_CONTROL_INTERFACE;
+
+    if (sim->Regs[0][VL53L0X_REG_RESULT_INTERRUPT_STATUS] != 0)
+        return VL53L0X_ERROR_NONE;
+
+    // skip from measurement to measurement until one raises the interrupt
+    gpio1->Waits++;
+    while (sim->Ranging && (TimeoutMs == VL53L0X_WAIT_FOREVER ||
+            (int32_t)(deadline - sim->ReadyUs) >= 0)) {
+        sim_time_us = sim->ReadyUs;
+        sim_update(Dev, sim);
+        if (sim->Regs[0][VL53L0X_REG_RESULT_INTERRUPT_STATUS] != 0)
+            return VL53L0X_ERROR_NONE;
+    }
+    sim_time_us = deadline;
+    return VL53L0X_ERROR_TIME_OUT;
+}
+
+VL53L0X_Error VL53L0X_WaitDataReady(VL53L0X_DEV Dev)
+{
+    VL53L0X_Gpio1_t *gpio1 = &Dev->gpio1;
+    VL53L0X_SimDevice_t *sim;
+    VL53L0X_Error status;
+
+    if (!gpio1->Enabled)
+        return VL53L0X_PollingDelay(Dev);
+
+    status = VL53L0X_FlushWriteBatch(Dev);
+
+    sim = sim_find(Dev);
+    if (sim == NULL || sim->Regs[0][VL53L0X_REG_RESULT_INTERRUPT_STATUS] != 0)
+        return status;
+
+    // sleep until the edge, or time out like the target when none comes
+    gpio1->Waits++;
+    if (sim->Ranging && (int32_t)(sim->ReadyUs - sim_time_us) > 0) {
+        sim_time_us = sim->ReadyUs;
+        sim_update(Dev, sim);
+    } else if (!sim->Ranging) {
+        gpio1->Timeouts++;
+        sim_time_us += PALDevDataGet(Dev, CurrentParameters.MeasurementTimingBudgetMicroSeconds);
+    }
+
+    return status;
+}
+
+#endif /* VL53L0X_PLATFORM_SIM */
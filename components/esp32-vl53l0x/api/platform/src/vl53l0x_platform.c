@@ -1,24 +1,437 @@
 #include "vl53l0x_platform.h"
+#include "vl53l0x_i2c_platform.h"
 
-#include "driver/i2c.h"
-#include "esp_err.h"
-#include "esp_log.h"
-
-#define ACK_CHECK_EN true
-
-VL53L0X_Error esp_to_vl53l0x_error(esp_err_t esp_err) {
-    switch (esp_err) {
-        case ESP_OK:
-            return VL53L0X_ERROR_NONE;
-        case ESP_ERR_INVALID_ARG:
-            return VL53L0X_ERROR_INVALID_PARAMS;
-        case ESP_FAIL:
-        case ESP_ERR_INVALID_STATE:
-            return VL53L0X_ERROR_CONTROL_INTERFACE;
-        case ESP_ERR_TIMEOUT:
-            return VL53L0X_ERROR_TIME_OUT;
-        default:
-            return VL53L0X_ERROR_UNDEFINED;
+// the bus mutex, counting the times another task had it
+static void bus_lock(VL53L0X_DEV Dev)
+{
+    uint32_t start;
+
+    if (VL53L0X_i2c_lock(Dev, 0))
+        return;
+
+    start = VL53L0X_GetTickCountUs();
+    VL53L0X_i2c_lock(Dev, 1);
+    Dev->i2c_stats.BusWaits++;
+    Dev->i2c_stats.BusWaitUs += VL53L0X_GetTickCountUs() - start;
+}
+
+// counted on the device whose transaction failed
+static void bus_recover(VL53L0X_DEV Dev)
+{
+    uint8_t result = VL53L0X_i2c_recover(Dev);
+
+    if (result & VL53L0X_I2C_RECOVER_DRIVER)
+        Dev->i2c_stats.BusRecoveries++;
+    if (result & VL53L0X_I2C_RECOVER_SDA)
+        Dev->i2c_stats.SdaClears++;
+    if (result & VL53L0X_I2C_RECOVER_FAILED)
+        Dev->i2c_stats.RecoveryFailures++;
+}
+
+/*
+ * Timeout of the next transaction, bus mutex held: the phase's limit, cut
+ * to what is left of the API call's budget. 0 when the budget is spent.
+ */
+static uint32_t bus_timeout(VL53L0X_DEV Dev)
+{
+    VL53L0X_BusTiming_t *timing = &Dev->bus_timing;
+    uint32_t timeout = timing->Deadline[timing->Phase].TransactionMs;
+    int32_t left_us;
+
+    if (timeout == 0)
+        timeout = VL53L0X_BUS_TIMEOUT_DEFAULT_MS;
+    if (!timing->CallArmed)
+        return timeout;
+
+    left_us = (int32_t)(timing->CallDeadlineUs - VL53L0X_GetTickCountUs());
+    if (left_us <= 0) {
+        Dev->i2c_stats.BudgetRefusals++;
+        return 0;
+    }
+    // rounded up, or the last few hundred us would refuse the transaction
+    if ((uint32_t)left_us < timeout * 1000)
+        timeout = ((uint32_t)left_us + 999) / 1000;
+    return timeout;
+}
+
+// after the transaction, bus mutex held
+static void bus_account(VL53L0X_DEV Dev, VL53L0X_Error status, uint32_t start,
+    uint32_t bytes)
+{
+    uint32_t elapsed = VL53L0X_GetTickCountUs() - start;
+
+#ifdef VL53L0X_TRACE_PROFILE
+    VL53L0X_profile_transaction(bytes, elapsed);
+#endif
+
+    Dev->i2c_stats.BusTimeUs += elapsed;
+    VL53L0X_HistogramAdd(Dev->i2c_stats.Latency, VL53L0X_I2C_LATENCY_BINS,
+        VL53L0X_I2C_LATENCY_SHIFT, elapsed);
+    if (elapsed > Dev->i2c_stats.LatencyMaxUs)
+        Dev->i2c_stats.LatencyMaxUs = elapsed;
+    if (status == VL53L0X_ERROR_TIME_OUT)
+        Dev->i2c_stats.DeadlineMisses++;
+    if (status != VL53L0X_ERROR_NONE)
+        bus_recover(Dev);
+}
+
+static VL53L0X_Error i2c_write(VL53L0X_DEV Dev, const VL53L0X_I2cWrite_t *pWrites, uint8_t count, uint8_t writes)
+{
+    VL53L0X_Error status;
+    uint32_t bytes = 0;
+    uint32_t timeout;
+    uint32_t start;
+
+    bus_lock(Dev);
+    timeout = bus_timeout(Dev);
+    if (timeout == 0) {
+        VL53L0X_i2c_unlock(Dev);
+        return VL53L0X_ERROR_TIME_OUT;
+    }
+    start = VL53L0X_GetTickCountUs();
+    status = VL53L0X_i2c_write(Dev, pWrites, count, timeout);
+    for (int i = 0; i < count; i++)
+        bytes += pWrites[i].Count;
+    bus_account(Dev, status, start, bytes);
+    VL53L0X_i2c_unlock(Dev);
+
+    Dev->i2c_stats.Transactions++;
+    Dev->i2c_stats.MergedWrites += writes - 1;
+    Dev->i2c_stats.BytesWritten += bytes;
+
+    return status;
+}
+
+static VL53L0X_Error i2c_read(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count)
+{
+    VL53L0X_Error status;
+    uint32_t timeout;
+    uint32_t start;
+
+    bus_lock(Dev);
+    timeout = bus_timeout(Dev);
+    if (timeout == 0) {
+        VL53L0X_i2c_unlock(Dev);
+        return VL53L0X_ERROR_TIME_OUT;
+    }
+    start = VL53L0X_GetTickCountUs();
+    status = VL53L0X_i2c_read(Dev, index, pdata, count, timeout);
+    bus_account(Dev, status, start, count);
+    VL53L0X_i2c_unlock(Dev);
+
+    Dev->i2c_stats.Transactions++;
+    Dev->i2c_stats.ReadTransactions++;
+    Dev->i2c_stats.BytesRead += count;
+
+    return status;
+}
+
+VL53L0X_Error VL53L0X_SetBusDeadline(VL53L0X_DEV Dev, uint8_t Phase,
+    uint32_t TransactionMs, uint32_t CallMs)
+{
+    if (Phase >= VL53L0X_BUS_PHASES)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    Dev->bus_timing.Deadline[Phase].TransactionMs = TransactionMs;
+    Dev->bus_timing.Deadline[Phase].CallMs = CallMs;
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_SetBusPhase(VL53L0X_DEV Dev, uint8_t Phase)
+{
+    if (Phase >= VL53L0X_BUS_PHASES)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    Dev->bus_timing.Phase = Phase;
+    return VL53L0X_ERROR_NONE;
+}
+
+void VL53L0X_BeginCall(VL53L0X_DEV Dev, uint32_t BudgetMs)
+{
+    VL53L0X_BusTiming_t *timing = &Dev->bus_timing;
+
+    if (BudgetMs == 0)
+        BudgetMs = timing->Deadline[timing->Phase].CallMs;
+    timing->CallArmed = BudgetMs != 0;
+    timing->CallDeadlineUs = VL53L0X_GetTickCountUs() + BudgetMs * 1000;
+}
+
+void VL53L0X_EndCall(VL53L0X_DEV Dev)
+{
+    Dev->bus_timing.CallArmed = 0;
+}
+
+void VL53L0X_MeasurementStarted(VL53L0X_DEV Dev)
+{
+    Dev->measurement_times.StartUs = VL53L0X_GetTickCountUs();
+}
+
+void VL53L0X_GetMeasurementTimes(VL53L0X_DEV Dev, uint32_t *pStartUs,
+    uint32_t *pEndUs)
+{
+    VL53L0X_MeasurementTimes_t *times = &Dev->measurement_times;
+    VL53L0X_DeviceParameters_t *params = &PALDevDataGet(Dev, CurrentParameters);
+    uint32_t now = VL53L0X_GetTickCountUs();
+    uint32_t ready = Dev->gpio1.ReadyUs;
+    uint32_t since = times->StartUs;
+    uint32_t start = times->StartUs;
+    uint32_t end = now;
+
+    // an interrupt before that belongs to an older measurement
+    if ((int32_t)(times->ReadoutUs - since) > 0)
+        since = times->ReadoutUs;
+    if (Dev->gpio1.Enabled && (int32_t)(ready - since) > 0 &&
+            (int32_t)(now - ready) >= 0)
+        end = ready;
+
+    if (params->DeviceMode != VL53L0X_DEVICEMODE_SINGLE_RANGING &&
+            (int32_t)(end - params->MeasurementTimingBudgetMicroSeconds - start) > 0)
+        start = end - params->MeasurementTimingBudgetMicroSeconds;
+
+    *pStartUs = start;
+    *pEndUs = end;
+}
+
+void VL53L0X_MeasurementReadOut(VL53L0X_DEV Dev)
+{
+    VL53L0X_MeasurementTimes_t *times = &Dev->measurement_times;
+
+    // stats cleared since the last readout: count from there
+    if (times->ReadoutTransactions > Dev->i2c_stats.Transactions)
+        times->ReadoutTransactions = 0;
+    Dev->i2c_stats.Samples++;
+    Dev->i2c_stats.SampleTransactions += Dev->i2c_stats.Transactions - times->ReadoutTransactions;
+    times->ReadoutTransactions = Dev->i2c_stats.Transactions;
+
+    times->ReadoutUs = VL53L0X_GetTickCountUs();
+}
+
+uint8_t VL53L0X_InterruptSinceReadOut(VL53L0X_DEV Dev)
+{
+    return Dev->gpio1.Enabled &&
+        (int32_t)(Dev->gpio1.ReadyUs - Dev->measurement_times.ReadoutUs) > 0;
+}
+
+VL53L0X_Error VL53L0X_FlushWriteBatch(VL53L0X_DEV Dev)
+{
+    VL53L0X_WriteBatch_t *batch = &Dev->write_batch;
+    VL53L0X_I2cWrite_t writes[VL53L0X_WRITE_BATCH_SIZE];
+    VL53L0X_Error status;
+    uint32_t offset = 0;
+
+    if (batch->Count == 0)
+        return VL53L0X_ERROR_NONE;
+
+    for (int i = 0; i < batch->Count; i++) {
+        writes[i].Index = batch->Index[i];
+        writes[i].Count = batch->Length[i];
+        writes[i].pData = &batch->Buffer[offset];
+        offset += batch->Length[i];
+    }
+
+    status = i2c_write(Dev, writes, batch->Count, batch->Writes);
+
+    // drop the queue even on error, the caller decides whether to retry
+    batch->Count = 0;
+    batch->Writes = 0;
+    batch->Used = 0;
+
+    // the shadow already holds the queued values, they may not have landed
+    if (status != VL53L0X_ERROR_NONE)
+        VL53L0X_InvalidateShadow(Dev);
+
+    return status;
+}
+
+VL53L0X_Error VL53L0X_BeginWriteBatch(VL53L0X_DEV Dev)
+{
+    Dev->write_batch.Depth++;
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_EndWriteBatch(VL53L0X_DEV Dev)
+{
+    if (Dev->write_batch.Depth == 0)
+        return VL53L0X_ERROR_INVALID_COMMAND;
+
+    Dev->write_batch.Depth--;
+    if (Dev->write_batch.Depth > 0)
+        return VL53L0X_ERROR_NONE;
+
+    return VL53L0X_FlushWriteBatch(Dev);
+}
+
+static VL53L0X_Error write_batch_queue(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count)
+{
+    VL53L0X_WriteBatch_t *batch = &Dev->write_batch;
+    VL53L0X_Error status = VL53L0X_ERROR_NONE;
+    int last = batch->Count - 1;
+
+    // make room first
+    if (batch->Count == VL53L0X_WRITE_BATCH_SIZE || batch->Used + count > VL53L0X_WRITE_BATCH_BUFFER) {
+        status = VL53L0X_FlushWriteBatch(Dev);
+        last = -1;
+    }
+    if (status != VL53L0X_ERROR_NONE)
+        return status;
+
+    memcpy(&batch->Buffer[batch->Used], pdata, count);
+    batch->Used += count;
+    batch->Writes++;
+
+    // the index auto-increments, so a write that continues the previous one
+    // is simply appended to its payload
+    if (last >= 0 && (uint32_t)batch->Index[last] + batch->Length[last] == index) {
+        batch->Length[last] += count;
+    } else {
+        batch->Index[batch->Count] = index;
+        batch->Length[batch->Count] = count;
+        batch->Count++;
+    }
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_InvalidateShadow(VL53L0X_DEV Dev)
+{
+    VL53L0X_Shadow_t *shadow = &Dev->shadow;
+
+    shadow->Known = 0;
+    memset(shadow->Valid, 0, sizeof(shadow->Valid));
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_SetShadowEnable(VL53L0X_DEV Dev, uint8_t Enable)
+{
+    VL53L0X_InvalidateShadow(Dev);
+    Dev->shadow.Enabled = Enable;
+
+    return VL53L0X_ERROR_NONE;
+}
+
+/*
+ * Registers that change without being written, or whose access has side
+ * effects: results and interrupt status, NVM access, soft reset and ids
+ * (polled by VL53L0X_ResetDevice), the reference SPAD enables (read back to
+ * verify the write) and the page 1 core results.
+ */
+static int shadow_volatile(uint8_t page, uint8_t index)
+{
+    if (page == 0)
+        return index == VL53L0X_REG_SYSRANGE_START ||
+            index == VL53L0X_REG_SYSTEM_INTERRUPT_CLEAR ||
+            (index >= VL53L0X_REG_RESULT_INTERRUPT_STATUS && index <= 0x21) ||
+            index == 0x83 || index == VL53L0X_REG_I2C_SLAVE_DEVICE_ADDRESS ||
+            (index >= 0x90 && index <= 0x94) ||
+            (index >= VL53L0X_REG_GLOBAL_CONFIG_SPAD_ENABLES_REF_0 &&
+             index <= VL53L0X_REG_GLOBAL_CONFIG_SPAD_ENABLES_REF_5) ||
+            index >= VL53L0X_REG_SOFT_RESET_GO2_SOFT_RESET_N;
+
+    return index == 0x00 || index == 0x04 || index == 0x91 ||
+        index >= VL53L0X_REG_RESULT_PEAK_SIGNAL_RATE_REF;
+}
+
+#define SHADOW_KNOWN_ALL (VL53L0X_SHADOW_KNOWN_PAGE | VL53L0X_SHADOW_KNOWN_POWER | VL53L0X_SHADOW_KNOWN_MODE)
+
+// normal register map selected and @a index is an ordinary register of it
+static int shadow_cacheable(const VL53L0X_Shadow_t *shadow, uint32_t index)
+{
+    if (!shadow->Enabled || shadow->Known != SHADOW_KNOWN_ALL)
+        return 0;
+    if (shadow->Page >= VL53L0X_SHADOW_PAGES || shadow->Power != 0x00 || shadow->Mode != 0x01)
+        return 0;
+    if (index == 0x80 || index >= 0xFF)
+        return 0;
+
+    return !shadow_volatile(shadow->Page, index);
+}
+
+static int shadow_valid(const VL53L0X_Shadow_t *shadow, uint8_t index)
+{
+    return (shadow->Valid[shadow->Page][index >> 5] >> (index & 31)) & 1;
+}
+
+// all bytes of the access are mirrored, @a pdata receives them if not NULL
+static int shadow_lookup(VL53L0X_Shadow_t *shadow, uint8_t index, uint8_t *pdata, uint32_t count)
+{
+    if (count == 0)
+        return 0;
+
+    for (uint32_t i = 0; i < count; i++)
+        if (!shadow_cacheable(shadow, index + i) || !shadow_valid(shadow, index + i))
+            return 0;
+
+    if (pdata != NULL)
+        memcpy(pdata, &shadow->Value[shadow->Page][index], count);
+    return 1;
+}
+
+// the page select registers themselves are tracked rather than mirrored
+static int shadow_select_unchanged(const VL53L0X_Shadow_t *shadow, uint8_t index, uint8_t data)
+{
+    if (index == 0xFF)
+        return (shadow->Known & VL53L0X_SHADOW_KNOWN_PAGE) && shadow->Page == data;
+    if (index == 0x80)
+        return (shadow->Known & VL53L0X_SHADOW_KNOWN_POWER) && shadow->Power == data;
+    return 0;
+}
+
+static int shadow_write_unchanged(VL53L0X_Shadow_t *shadow, uint8_t index, uint8_t *pdata, uint32_t count)
+{
+    if (!shadow->Enabled)
+        return 0;
+    if (count == 1 && shadow_select_unchanged(shadow, index, pdata[0]))
+        return 1;
+
+    return shadow_lookup(shadow, index, NULL, count) &&
+        memcmp(&shadow->Value[shadow->Page][index], pdata, count) == 0;
+}
+
+// remember a write, byte by byte since it may move the page select
+static void shadow_write(VL53L0X_Shadow_t *shadow, uint8_t index, uint8_t *pdata, uint32_t count)
+{
+    if (!shadow->Enabled)
+        return;
+
+    for (uint32_t i = 0; i < count && index + i <= 0xFF; i++) {
+        uint8_t reg = index + i;
+        uint32_t bit = 1u << (reg & 31);
+
+        if (shadow_cacheable(shadow, reg)) {
+            shadow->Value[shadow->Page][reg] = pdata[i];
+            shadow->Valid[shadow->Page][reg >> 5] |= bit;
+        } else if (!(shadow->Known & VL53L0X_SHADOW_KNOWN_PAGE)) {
+            // it went to some page, could be any of ours
+            memset(shadow->Valid, 0, sizeof(shadow->Valid));
+        } else if (shadow->Page < VL53L0X_SHADOW_PAGES) {
+            // written through the hidden map, may alias the normal one
+            shadow->Valid[shadow->Page][reg >> 5] &= ~bit;
+        }
+
+        if (reg == 0xFF) {
+            shadow->Page = pdata[i];
+            shadow->Known |= VL53L0X_SHADOW_KNOWN_PAGE;
+        } else if (reg == 0x80) {
+            shadow->Power = pdata[i];
+            shadow->Known |= VL53L0X_SHADOW_KNOWN_POWER;
+        } else if (reg == 0x00 && (shadow->Known & VL53L0X_SHADOW_KNOWN_PAGE) && shadow->Page == 1) {
+            shadow->Mode = pdata[i];
+            shadow->Known |= VL53L0X_SHADOW_KNOWN_MODE;
+        }
+    }
+}
+
+// remember what a bus read returned
+static void shadow_fill(VL53L0X_Shadow_t *shadow, uint8_t index, uint8_t *pdata, uint32_t count)
+{
+    for (uint32_t i = 0; i < count && index + i < 0xFF; i++) {
+        uint8_t reg = index + i;
+
+        if (shadow_cacheable(shadow, reg)) {
+            shadow->Value[shadow->Page][reg] = pdata[i];
+            shadow->Valid[shadow->Page][reg >> 5] |= 1u << (reg & 31);
+        }
     }
 }
 
@@ -33,28 +446,32 @@ VL53L0X_Error esp_to_vl53l0x_error(esp_err_t esp_err) {
  */
 VL53L0X_Error VL53L0X_WriteMulti(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count)
 {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-
-    // write I2C address
-    i2c_master_write_byte(cmd, ( Dev->i2c_address << 1 ) | I2C_MASTER_WRITE, ACK_CHECK_EN);
-
-    // write register
-    i2c_master_write_byte(cmd, index, ACK_CHECK_EN);
+    VL53L0X_I2cWrite_t write;
+    VL53L0X_Error status;
 
-    // Data
-    // Note: Needed to use i2c_master_write_byte as i2c_master_write will not expect an ack
-    // after each byte
-    for (int i = 0; i < count; i++)
-    {
-        i2c_master_write_byte(cmd, *(pdata + i), ACK_CHECK_EN);
+    if (shadow_write_unchanged(&Dev->shadow, index, pdata, count)) {
+        Dev->i2c_stats.SkippedWrites++;
+        return VL53L0X_ERROR_NONE;
+    }
+    shadow_write(&Dev->shadow, index, pdata, count);
+
+    if (Dev->write_batch.Depth > 0 && count <= VL53L0X_WRITE_BATCH_BUFFER) {
+        status = write_batch_queue(Dev, index, pdata, count);
+    } else {
+        // too large to be queued: keep the ordering with what is already queued
+        status = VL53L0X_FlushWriteBatch(Dev);
+        if (status == VL53L0X_ERROR_NONE) {
+            write.Index = index;
+            write.Count = count;
+            write.pData = pdata;
+            status = i2c_write(Dev, &write, 1, 1);
+        }
     }
 
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(Dev->i2c_port_num, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    if (status != VL53L0X_ERROR_NONE)
+        VL53L0X_InvalidateShadow(Dev);
 
-    return esp_to_vl53l0x_error(ret);
+    return status;
 }
 
 /**
@@ -68,31 +485,25 @@ VL53L0X_Error VL53L0X_WriteMulti(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata,
  */
 VL53L0X_Error VL53L0X_ReadMulti(VL53L0X_DEV Dev, uint8_t index, uint8_t *pdata, uint32_t count)
 {
-    // I2C write
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-    ////// First tell the VL53L0X which register we are reading from
-    ESP_ERROR_CHECK(i2c_master_start(cmd));
-
-    // Write I2C address
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, ( Dev->i2c_address << 1 ) | I2C_MASTER_WRITE, ACK_CHECK_EN));
-    // Write register
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, index, ACK_CHECK_EN));
-
-    ////// Second, read from the register
-    ESP_ERROR_CHECK(i2c_master_start(cmd));
+    VL53L0X_Error status;
 
-    // Write I2C address
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, ( Dev->i2c_address << 1 ) | I2C_MASTER_READ, ACK_CHECK_EN));
+    // the shadow already reflects queued writes, no need to flush them
+    if (shadow_lookup(&Dev->shadow, index, pdata, count)) {
+        Dev->i2c_stats.CachedReads++;
+        return VL53L0X_ERROR_NONE;
+    }
 
-    // Read data from register
-    ESP_ERROR_CHECK(i2c_master_read(cmd, pdata, count, I2C_MASTER_LAST_NACK));
+    // queued writes may change what we are about to read
+    status = VL53L0X_FlushWriteBatch(Dev);
+    if (status == VL53L0X_ERROR_NONE)
+        status = i2c_read(Dev, index, pdata, count);
 
-    ESP_ERROR_CHECK(i2c_master_stop(cmd));
-    esp_err_t ret = i2c_master_cmd_begin(Dev->i2c_port_num, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    if (status == VL53L0X_ERROR_NONE)
+        shadow_fill(&Dev->shadow, index, pdata, count);
+    else
+        VL53L0X_InvalidateShadow(Dev);
 
-    return esp_to_vl53l0x_error(ret);
+    return status;
 }
 
 /**
@@ -225,22 +636,3 @@ VL53L0X_Error VL53L0X_UpdateByte(VL53L0X_DEV Dev, uint8_t index, uint8_t AndData
 }
 
 /** @} end of VL53L0X_registerAccess_group */
-
-
-/**
- * @brief execute delay in all polling API call
- *
- * A typical multi-thread or RTOs implementation is to sleep the task for some 5ms (with 100Hz max rate faster polling is not needed)
- * if nothing specific is need you can define it as an empty/void macro
- * @code
- * #define VL53L0X_PollingDelay(...) (void)0
- * @endcode
- * @param Dev       Device Handle
- * @return  VL53L0X_ERROR_NONE        Success
- * @return  "Other error code"    See ::VL53L0X_Error
- */
-VL53L0X_Error VL53L0X_PollingDelay(VL53L0X_DEV Dev)
-{
-    vTaskDelay(1 / portTICK_RATE_MS);
-    return VL53L0X_ERROR_NONE;
-}
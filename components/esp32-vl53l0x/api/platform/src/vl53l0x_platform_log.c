@@ -1,4 +1,5 @@
 #include "vl53l0x_platform_log.h"
+#include "vl53l0x_platform.h"
 
 uint32_t _trace_level = TRACE_LEVEL_ALL;
 int _modules = TRACE_MODULE_ALL;
@@ -9,3 +10,267 @@ int32_t VL53L0X_trace_config(char *filename, uint32_t modules, uint32_t level, u
     _modules = modules;
     return 0;
 }
+
+#ifdef VL53L0X_TRACE_BINARY
+
+#define TRACE_RING_RECORDS CONFIG_VL53L0X_TRACE_RING_RECORDS
+
+static VL53L0X_TraceRecord_t trace_ring[TRACE_RING_RECORDS];
+static uint32_t trace_head;               /* records written since the last clear */
+
+void VL53L0X_trace_record(uint8_t module, uint8_t event, const char *function, int32_t status)
+{
+    VL53L0X_TraceRecord_t *record;
+
+    if ((module & _modules) == 0)
+        return;
+
+    // claim a slot, several tasks may trace at once
+    record = &trace_ring[__atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED) % TRACE_RING_RECORDS];
+
+    record->Function = function;
+    record->Task = xTaskGetCurrentTaskHandle();
+    record->TimeUs = VL53L0X_GetTickCountUs();
+    record->Status = (int16_t)status;
+    record->Event = event;
+    record->Module = module;
+}
+
+void VL53L0X_trace_dump(void)
+{
+    uint32_t head = trace_head;
+    uint32_t count = head < TRACE_RING_RECORDS ? head : TRACE_RING_RECORDS;
+
+    // header: records, records lost to wrap-around, record size
+    printf("VL53L0X-TRACE-BEGIN %u %u %u\n", count, head - count, sizeof(VL53L0X_TraceRecord_t));
+
+    for (uint32_t i = head - count; i != head; i++) {
+        const uint8_t *bytes = (const uint8_t *)&trace_ring[i % TRACE_RING_RECORDS];
+
+        for (int j = 0; j < sizeof(VL53L0X_TraceRecord_t); j++)
+            printf("%02x", bytes[j]);
+        printf("\n");
+    }
+
+    printf("VL53L0X-TRACE-END\n");
+}
+
+void VL53L0X_trace_clear(void)
+{
+    trace_head = 0;
+}
+
+#endif
+
+#ifdef VL53L0X_TRACE_PROFILE
+
+#define PROFILE_FUNCTIONS CONFIG_VL53L0X_PROFILE_FUNCTIONS
+
+// tasks inside an API call at the same time, and call depth followed per task
+#define PROFILE_TASKS 8
+#define PROFILE_DEPTH 16
+
+typedef struct {
+    const char *Function;                 /* its entry may be the shared "(table full)" one */
+    VL53L0X_ProfileEntry_t *Entry;
+    uint32_t    Transactions;             /* of the task when the function was entered */
+    uint32_t    BusTimeUs;
+} profile_frame_t;
+
+typedef struct {
+    void       *Task;
+    uint32_t    Depth;                    /* may exceed PROFILE_DEPTH, deeper calls are not followed */
+    uint32_t    Transactions;             /* of the task since it claimed the stack */
+    uint32_t    BusTimeUs;
+    profile_frame_t Frames[PROFILE_DEPTH];
+} profile_stack_t;
+
+static VL53L0X_ProfileEntry_t profile_table[PROFILE_FUNCTIONS];
+static VL53L0X_ProfileEntry_t profile_outside = { .Function = "(no API function)" };
+static VL53L0X_ProfileEntry_t profile_full = { .Function = "(table full)" };
+static profile_stack_t profile_stacks[PROFILE_TASKS];
+
+#ifdef VL53L0X_PLATFORM_SIM
+// the host build has a single task
+#define profile_task()      NULL
+#define profile_lock()      (void)0
+#define profile_unlock()    (void)0
+#else
+static portMUX_TYPE profile_mux = portMUX_INITIALIZER_UNLOCKED;
+#define profile_task()      ((void *)xTaskGetCurrentTaskHandle())
+#define profile_lock()      portENTER_CRITICAL(&profile_mux)
+#define profile_unlock()    portEXIT_CRITICAL(&profile_mux)
+#endif
+
+// open addressing on the __FUNCTION__ address, profile locked
+static VL53L0X_ProfileEntry_t *profile_entry(const char *function)
+{
+    uint32_t slot = ((uintptr_t)function >> 2) % PROFILE_FUNCTIONS;
+
+    for (int i = 0; i < PROFILE_FUNCTIONS; i++) {
+        VL53L0X_ProfileEntry_t *entry = &profile_table[(slot + i) % PROFILE_FUNCTIONS];
+
+        if (entry->Function == function)
+            return entry;
+        if (entry->Function == NULL) {
+            entry->Function = function;
+            return entry;
+        }
+    }
+    return &profile_full;
+}
+
+// the calling task's stack, a free one is claimed if @a claim, profile locked
+static profile_stack_t *profile_stack(int claim)
+{
+    void *task = profile_task();
+    profile_stack_t *free = NULL;
+
+    for (int i = 0; i < PROFILE_TASKS; i++) {
+        if (profile_stacks[i].Depth > 0 && profile_stacks[i].Task == task)
+            return &profile_stacks[i];
+        if (profile_stacks[i].Depth == 0 && free == NULL)
+            free = &profile_stacks[i];
+    }
+    if (!claim || free == NULL)
+        return NULL;
+
+    free->Task = task;
+    free->Transactions = 0;
+    free->BusTimeUs = 0;
+    return free;
+}
+
+void VL53L0X_profile_enter(uint8_t module, const char *function)
+{
+    profile_stack_t *stack;
+    VL53L0X_ProfileEntry_t *entry;
+
+    if ((module & _modules) == 0)
+        return;
+
+    profile_lock();
+    entry = profile_entry(function);
+    entry->Calls++;
+    stack = profile_stack(1);
+    if (stack != NULL) {
+        if (stack->Depth < PROFILE_DEPTH) {
+            stack->Frames[stack->Depth].Function = function;
+            stack->Frames[stack->Depth].Entry = entry;
+            stack->Frames[stack->Depth].Transactions = stack->Transactions;
+            stack->Frames[stack->Depth].BusTimeUs = stack->BusTimeUs;
+        }
+        stack->Depth++;
+    }
+    profile_unlock();
+}
+
+void VL53L0X_profile_exit(uint8_t module, const char *function)
+{
+    profile_stack_t *stack;
+    profile_frame_t *frame;
+    uint32_t depth;
+
+    if ((module & _modules) == 0)
+        return;
+
+    profile_lock();
+    stack = profile_stack(0);
+    if (stack == NULL || stack->Depth > PROFILE_DEPTH) {
+        if (stack != NULL)
+            stack->Depth--;
+        profile_unlock();
+        return;
+    }
+
+    // a callee that returned without its END trace point is closed too
+    for (depth = stack->Depth; depth > 0; depth--)
+        if (stack->Frames[depth - 1].Function == function)
+            break;
+
+    while (depth > 0 && stack->Depth >= depth) {
+        frame = &stack->Frames[--stack->Depth];
+        frame->Entry->TotalTransactions += stack->Transactions - frame->Transactions;
+        frame->Entry->TotalBusTimeUs += stack->BusTimeUs - frame->BusTimeUs;
+    }
+    profile_unlock();
+}
+
+void VL53L0X_profile_transaction(uint32_t bytes, uint32_t busUs)
+{
+    profile_stack_t *stack;
+    VL53L0X_ProfileEntry_t *entry = &profile_outside;
+
+    profile_lock();
+    stack = profile_stack(0);
+    if (stack != NULL) {
+        entry = stack->Frames[(stack->Depth < PROFILE_DEPTH ? stack->Depth : PROFILE_DEPTH) - 1].Entry;
+        stack->Transactions++;
+        stack->BusTimeUs += busUs;
+    }
+    entry->Transactions++;
+    entry->Bytes += bytes;
+    entry->BusTimeUs += busUs;
+    profile_unlock();
+}
+
+static void profile_print(const VL53L0X_ProfileEntry_t *entry)
+{
+    printf("%8u %8u %9u %10u %8u %10u %s\n", entry->Calls, entry->Transactions,
+        entry->Bytes, entry->BusTimeUs, entry->TotalTransactions,
+        entry->TotalBusTimeUs, entry->Function);
+}
+
+void VL53L0X_profile_dump(void)
+{
+    uint8_t printed[PROFILE_FUNCTIONS] = { 0 };
+    VL53L0X_ProfileEntry_t *next;
+
+    printf("VL53L0X-PROFILE-BEGIN\n");
+    printf("%8s %8s %9s %10s %8s %10s %s\n", "calls", "tx", "bytes",
+        "bus_us", "incl_tx", "incl_us", "function");
+
+    // selection by own bus time, the table is small
+    for (;;) {
+        next = NULL;
+        for (int i = 0; i < PROFILE_FUNCTIONS; i++) {
+            if (profile_table[i].Function == NULL || printed[i])
+                continue;
+            // not called since the last clear
+            if (profile_table[i].Calls == 0 && profile_table[i].Transactions == 0)
+                continue;
+            if (next == NULL || profile_table[i].BusTimeUs > next->BusTimeUs)
+                next = &profile_table[i];
+        }
+        if (next == NULL)
+            break;
+        printed[next - profile_table] = 1;
+        profile_print(next);
+    }
+    if (profile_outside.Transactions > 0)
+        profile_print(&profile_outside);
+    if (profile_full.Calls > 0)
+        profile_print(&profile_full);
+
+    printf("VL53L0X-PROFILE-END\n");
+}
+
+static void profile_zero(VL53L0X_ProfileEntry_t *entry)
+{
+    const char *function = entry->Function;
+
+    memset(entry, 0, sizeof(*entry));
+    entry->Function = function;
+}
+
+void VL53L0X_profile_clear(void)
+{
+    profile_lock();
+    for (int i = 0; i < PROFILE_FUNCTIONS; i++)
+        profile_zero(&profile_table[i]);
+    profile_zero(&profile_outside);
+    profile_zero(&profile_full);
+    profile_unlock();
+}
+
+#endif
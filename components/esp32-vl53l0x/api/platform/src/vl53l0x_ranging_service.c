@@ -0,0 +1,342 @@
+#include "vl53l0x_ranging_service.h"
+#include "vl53l0x_api.h"
+
+// needs FreeRTOS tasks, not part of the host build
+#ifndef VL53L0X_PLATFORM_SIM
+
+#define RING_MASK (VL53L0X_RANGING_RING_SIZE - 1)
+
+#define RANGING_TASK_STACK 4096
+
+// errors in a row before the device is reinitialized
+#define RANGING_REINIT_ERRORS 3
+
+// periods without a measurement before a device that answers counts as failed
+#define RANGING_STALL_PERIODS 4
+
+#define RANGING_REINIT_MAX_BACKOFF_MS 8000
+
+static void ranging_publish(VL53L0X_RangingService_t *pService,
+    const VL53L0X_RangingMeasurementData_t *pData, FixPoint1616_t sigma)
+{
+    uint32_t number = pService->Published;
+    VL53L0X_RangingSlot_t *slot = &pService->Ring[number & RING_MASK];
+
+    // odd: readers of the old sample in this slot give up on it
+    slot->Sequence++;
+    __sync_synchronize();
+
+    slot->Sample.Number = number;
+    slot->Sample.TimeUs = VL53L0X_GetTickCountUs();
+    slot->Sample.SigmaMilliMeter = sigma;
+    slot->Sample.Data = *pData;
+
+    __sync_synchronize();
+    slot->Sequence++;
+    __sync_synchronize();
+
+    pService->Published = number + 1;
+}
+
+// device locked and not ranging
+static VL53L0X_Error ranging_start(VL53L0X_RangingService_t *pService)
+{
+    VL53L0X_DEV Dev = pService->Dev;
+    VL53L0X_Error Status;
+
+    VL53L0X_SetBusPhase(Dev, VL53L0X_BUS_PHASE_RANGING);
+    Status = VL53L0X_SetDeviceMode(Dev, VL53L0X_DEVICEMODE_CONTINUOUS_TIMED_RANGING);
+    if (Status == VL53L0X_ERROR_NONE)
+        Status = VL53L0X_SetInterMeasurementPeriodMilliSeconds(Dev, pService->PeriodMs);
+    if (Status == VL53L0X_ERROR_NONE)
+        Status = VL53L0X_StartMeasurement(Dev);
+    return Status;
+}
+
+static VL53L0X_Error ranging_reinit(VL53L0X_RangingService_t *pService,
+    VL53L0X_ReinitFunc_t reinit)
+{
+    VL53L0X_DEV Dev = pService->Dev;
+    VL53L0X_Error Status;
+
+    VL53L0X_LockDevice(Dev);
+    // may well fail, the device is in an unknown state
+    VL53L0X_StopMeasurement(Dev);
+    VL53L0X_InvalidateShadow(Dev);
+    Status = reinit(Dev, pService->pReinitArg);
+    if (Status == VL53L0X_ERROR_NONE)
+        Status = ranging_start(pService);
+    VL53L0X_UnlockDevice(Dev);
+
+    if (Status == VL53L0X_ERROR_NONE)
+        pService->Reinits++;
+    else
+        pService->ReinitFailures++;
+    return Status;
+}
+
+// sleeps, unless VL53L0X_StopRangingService() wakes the task; Running is
+// cleared before the notification, so a stop is never slept through
+static void ranging_backoff(VL53L0X_RangingService_t *pService, uint32_t ms)
+{
+    if (pService->Running)
+        ulTaskNotifyTake(pdTRUE, ms / portTICK_RATE_MS + 1);
+}
+
+static void ranging_task(void *arg)
+{
+    VL53L0X_RangingService_t *service = (VL53L0X_RangingService_t *)arg;
+    VL53L0X_DEV Dev = service->Dev;
+    VL53L0X_RangingMeasurementData_t data;
+    VL53L0X_ReinitFunc_t reinit;
+    FixPoint1616_t sigma = 0;
+    VL53L0X_Error status;
+    uint32_t failures = 0;
+    uint32_t backoff_ms;
+    uint32_t stall_us;
+    uint32_t last_us;
+    uint32_t start;
+    uint8_t ready;
+
+    last_us = VL53L0X_GetTickCountUs();
+    while (service->Running) {
+        // with GPIO1 the readout below finds the data there, no wasted poll
+        VL53L0X_WaitDataReady(Dev);
+        start = VL53L0X_GetTickCountUs();
+        VL53L0X_LockDevice(Dev);
+        // one readout, the ranging phase's call budget
+        VL53L0X_BeginCall(Dev, 0);
+        // data ready, data and interrupt clear in two transactions
+        status = VL53L0X_GetRangingMeasurementDataFast(Dev, &data, 0, &ready);
+        if (status == VL53L0X_ERROR_NONE && !ready) {
+            // answers on the bus but stopped ranging (reset by a glitch)
+            stall_us = (RANGING_STALL_PERIODS * service->PeriodMs +
+                PALDevDataGet(Dev, CurrentParameters).MeasurementTimingBudgetMicroSeconds / 1000) * 1000;
+            if (start - last_us < stall_us) {
+                VL53L0X_EndCall(Dev);
+                VL53L0X_UnlockDevice(Dev);
+                continue;
+            }
+            status = VL53L0X_ERROR_TIME_OUT;
+        }
+
+        // computed by the readout, no bus access
+        if (status == VL53L0X_ERROR_NONE)
+            status = VL53L0X_GetLimitCheckCurrent(Dev,
+                VL53L0X_CHECKENABLE_SIGMA_FINAL_RANGE, &sigma);
+        // readout time, device lock wait included
+        if (status == VL53L0X_ERROR_NONE) {
+            VL53L0X_StatsAddSample(&Dev->ranging_stats, &data, sigma,
+                VL53L0X_GetTickCountUs() - start);
+            // under the lock, VL53L0X_ReconfigureRangingService() finds
+            // every sample of the old settings published
+            ranging_publish(service, &data, sigma);
+        } else {
+            VL53L0X_StatsAddError(&Dev->ranging_stats, status);
+        }
+        VL53L0X_EndCall(Dev);
+        VL53L0X_UnlockDevice(Dev);
+
+        if (status == VL53L0X_ERROR_NONE) {
+            last_us = VL53L0X_GetTickCountUs();
+            failures = 0;
+            continue;
+        }
+
+        service->Errors++;
+        failures++;
+        reinit = service->Reinit;
+        if (reinit == NULL || failures < RANGING_REINIT_ERRORS) {
+            // back off for a period, the device keeps ranging on its own
+            ranging_backoff(service, service->PeriodMs);
+            continue;
+        }
+
+        if (ranging_reinit(service, reinit) == VL53L0X_ERROR_NONE) {
+            last_us = VL53L0X_GetTickCountUs();
+            failures = 0;
+            continue;
+        }
+        // doubled per failed attempt, the sensor may be gone for good
+        backoff_ms = service->PeriodMs;
+        for (uint32_t i = RANGING_REINIT_ERRORS; i < failures &&
+                backoff_ms < RANGING_REINIT_MAX_BACKOFF_MS; i++)
+            backoff_ms *= 2;
+        if (backoff_ms > RANGING_REINIT_MAX_BACKOFF_MS)
+            backoff_ms = RANGING_REINIT_MAX_BACKOFF_MS;
+        ranging_backoff(service, backoff_ms);
+    }
+
+    VL53L0X_LockDevice(Dev);
+    VL53L0X_StopMeasurement(Dev);
+    VL53L0X_ClearInterruptMask(Dev, 0);
+    VL53L0X_SetDeviceMode(Dev, VL53L0X_DEVICEMODE_SINGLE_RANGING);
+    VL53L0X_UnlockDevice(Dev);
+
+    // VL53L0X_StopRangingService() deletes the task: its handle stays valid
+    // for the stop's notification until then
+    service->Exited = 1;
+    vTaskSuspend(NULL);
+}
+
+VL53L0X_Error VL53L0X_StartRangingService(VL53L0X_RangingService_t *pService,
+    VL53L0X_DEV Dev, uint32_t PeriodMs, UBaseType_t Priority)
+{
+    VL53L0X_Error Status;
+    TaskHandle_t task;
+
+    // field by field, readers of the last generation may still be at it.
+    // The ring is left alone: a slot's sequence only ever counts up, and
+    // its sample number is only trusted below the published count.
+    pService->Task = NULL;
+    pService->Exited = 0;
+    pService->Reinit = NULL;
+    pService->pReinitArg = NULL;
+    pService->Errors = 0;
+    pService->Reinits = 0;
+    pService->ReinitFailures = 0;
+    pService->Published = 0;
+    // readers see the new generation only with the count already reset
+    __sync_synchronize();
+    pService->Generation++;
+    pService->Dev = Dev;
+    pService->PeriodMs = PeriodMs;
+    pService->Running = 1;
+
+    VL53L0X_LockDevice(Dev);
+    Status = ranging_start(pService);
+    VL53L0X_UnlockDevice(Dev);
+    if (Status != VL53L0X_ERROR_NONE)
+        return Status;
+
+    if (xTaskCreate(ranging_task, "vl53l0x", RANGING_TASK_STACK, pService,
+            Priority, &task) != pdPASS) {
+        VL53L0X_LockDevice(Dev);
+        VL53L0X_StopMeasurement(Dev);
+        VL53L0X_SetDeviceMode(Dev, VL53L0X_DEVICEMODE_SINGLE_RANGING);
+        VL53L0X_UnlockDevice(Dev);
+        return VL53L0X_ERROR_UNDEFINED;
+    }
+    pService->Task = task;
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_StopRangingService(VL53L0X_RangingService_t *pService)
+{
+    TaskHandle_t task = pService->Task;
+
+    if (task == NULL)
+        return VL53L0X_ERROR_NONE;
+
+    pService->Running = 0;
+    __sync_synchronize();
+    // cuts a data ready wait or a reinit backoff short
+    xTaskNotifyGive(task);
+
+    // then the task only stops the device
+    while (!pService->Exited)
+        vTaskDelay(1);
+    vTaskDelete(task);
+    pService->Task = NULL;
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_ReconfigureRangingService(
+    VL53L0X_RangingService_t *pService, uint32_t PeriodMs,
+    VL53L0X_ConfigureFunc_t Configure, void *pArg, uint32_t *pFirstNumber)
+{
+    VL53L0X_DEV Dev = pService->Dev;
+    VL53L0X_Error Status;
+
+    if (pService->Task == NULL)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    // the task waits for data ready meanwhile, or for the lock
+    VL53L0X_LockDevice(Dev);
+    Status = VL53L0X_StopMeasurement(Dev);
+    // a result of the old settings is not read as one of the new
+    if (Status == VL53L0X_ERROR_NONE)
+        Status = VL53L0X_ClearInterruptMask(Dev, 0);
+    if (Status == VL53L0X_ERROR_NONE)
+        Status = Configure(Dev, pArg);
+    if (Status == VL53L0X_ERROR_NONE) {
+        pService->PeriodMs = PeriodMs;
+        Status = ranging_start(pService);
+    }
+    if (pFirstNumber != NULL)
+        *pFirstNumber = pService->Published;
+    VL53L0X_UnlockDevice(Dev);
+
+    return Status;
+}
+
+void VL53L0X_SetRangingReinit(VL53L0X_RangingService_t *pService,
+    VL53L0X_ReinitFunc_t Reinit, void *pArg)
+{
+    // the task reads Reinit first
+    pService->Reinit = NULL;
+    __sync_synchronize();
+    pService->pReinitArg = pArg;
+    __sync_synchronize();
+    pService->Reinit = Reinit;
+}
+
+uint32_t VL53L0X_GetRangingGeneration(const VL53L0X_RangingService_t *pService)
+{
+    uint32_t generation = pService->Generation;
+
+    // pairs with the barrier in VL53L0X_StartRangingService()
+    __sync_synchronize();
+    return generation;
+}
+
+uint32_t VL53L0X_GetRangingCount(const VL53L0X_RangingService_t *pService)
+{
+    return pService->Published;
+}
+
+VL53L0X_Error VL53L0X_GetRangingSample(const VL53L0X_RangingService_t *pService,
+    uint32_t Number, VL53L0X_RangingSample_t *pSample)
+{
+    const VL53L0X_RangingSlot_t *slot = &pService->Ring[Number & RING_MASK];
+    uint32_t published = pService->Published;
+    uint32_t sequence;
+
+    if (Number >= published || published - Number > VL53L0X_RANGING_RING_SIZE)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    sequence = slot->Sequence;
+    __sync_synchronize();
+
+    // the writer only ever rewrites a slot for a newer sample, so a slot in
+    // flux or changed under us means Number has been overwritten: no retry
+    if (sequence & 1)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    *pSample = slot->Sample;
+
+    __sync_synchronize();
+    if (slot->Sequence != sequence || pSample->Number != Number)
+        return VL53L0X_ERROR_INVALID_PARAMS;
+
+    return VL53L0X_ERROR_NONE;
+}
+
+VL53L0X_Error VL53L0X_GetLatestRanging(const VL53L0X_RangingService_t *pService,
+    VL53L0X_RangingSample_t *pSample)
+{
+    uint32_t published;
+
+    // only fails again if the writer lapped the whole ring meanwhile
+    do {
+        published = pService->Published;
+        if (published == 0)
+            return VL53L0X_ERROR_INVALID_PARAMS;
+    } while (VL53L0X_GetRangingSample(pService, published - 1, pSample) != VL53L0X_ERROR_NONE);
+
+    return VL53L0X_ERROR_NONE;
+}
+
+#endif /* VL53L0X_PLATFORM_SIM */
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <string.h>
+#include "vl53l0x_platform.h"
+
+#define LATENCY_FIRST_SHIFT 7
+
+static const uint8_t quantile_percent[VL53L0X_STATS_QUANTILES] =
+    VL53L0X_STATS_QUANTILE_PERCENT;
+
+static void quantile_init(VL53L0X_Quantile_t *q, float p)
+{
+    int i;
+
+    memset(q, 0, sizeof(*q));
+    for (i = 0; i < 5; i++)
+        q->Position[i] = i + 1;
+    q->Desired[0] = 1;
+    q->Desired[1] = 1 + 2 * p;
+    q->Desired[2] = 1 + 4 * p;
+    q->Desired[3] = 3 + 2 * p;
+    q->Desired[4] = 5;
+    q->Increment[0] = 0;
+    q->Increment[1] = p / 2;
+    q->Increment[2] = p;
+    q->Increment[3] = (1 + p) / 2;
+    q->Increment[4] = 1;
+}
+
+static float quantile_parabolic(const VL53L0X_Quantile_t *q, int i, int d)
+{
+    const float *h = q->Height;
+    const int32_t *n = q->Position;
+
+    return h[i] + (float)d / (n[i + 1] - n[i - 1]) *
+        ((n[i] - n[i - 1] + d) * (h[i + 1] - h[i]) / (n[i + 1] - n[i]) +
+         (n[i + 1] - n[i] - d) * (h[i] - h[i - 1]) / (n[i] - n[i - 1]));
+}
+
+static void quantile_add(VL53L0X_Quantile_t *q, float p, float x)
+{
+    float *h = q->Height;
+    int32_t *n = q->Position;
+    float estimate;
+    float delta;
+    int i;
+    int k;
+    int d;
+
+    // the first five samples are kept sorted, they become the markers
+    if (q->Count == 0)
+        quantile_init(q, p);
+    if (q->Count < 5) {
+        for (i = q->Count; i > 0 && h[i - 1] > x; i--)
+            h[i] = h[i - 1];
+        h[i] = x;
+        q->Count++;
+        return;
+    }
+    q->Count++;
+
+    if (x < h[0]) {
+        h[0] = x;
+        k = 0;
+    } else if (x >= h[4]) {
+        h[4] = x;
+        k = 3;
+    } else {
+        for (k = 0; x >= h[k + 1]; k++)
+            ;
+    }
+    for (i = k + 1; i < 5; i++)
+        n[i]++;
+    for (i = 0; i < 5; i++)
+        q->Desired[i] += q->Increment[i];
+
+    // move the middle markers towards their desired positions, one step
+    for (i = 1; i < 4; i++) {
+        delta = q->Desired[i] - n[i];
+        if ((delta >= 1 && n[i + 1] - n[i] > 1) ||
+                (delta <= -1 && n[i - 1] - n[i] < -1)) {
+            d = delta > 0 ? 1 : -1;
+            estimate = quantile_parabolic(q, i, d);
+            if (h[i - 1] < estimate && estimate < h[i + 1])
+                h[i] = estimate;
+            else
+                h[i] += d * (h[i + d] - h[i]) / (n[i + d] - n[i]);
+            n[i] += d;
+        }
+    }
+}
+
+float VL53L0X_StatsQuantile(const VL53L0X_Quantile_t *pQuantile)
+{
+    uint32_t count = pQuantile->Count;
+
+    if (count == 0)
+        return 0;
+    if (count >= 5)
+        return pQuantile->Height[2];
+    // warming up: nearest rank in the sorted samples, Desired[2] - 1 is 4p
+    return pQuantile->Height[(uint32_t)((count - 1) *
+        (pQuantile->Desired[2] - 1) / 4 + 0.5f)];
+}
+
+void VL53L0X_StatsClear(VL53L0X_Stats_t *pStats)
+{
+    memset(pStats, 0, sizeof(*pStats));
+}
+
+void VL53L0X_StatsAddSample(VL53L0X_Stats_t *pStats,
+    const VL53L0X_RangingMeasurementData_t *pData,
+    FixPoint1616_t SigmaMilliMeter, uint32_t LatencyUs)
+{
+    uint8_t status = pData->RangeStatus;
+    float p;
+    int i;
+
+    pStats->Samples++;
+    pStats->Status[status < VL53L0X_STATS_STATUS_BINS ? status :
+        VL53L0X_STATS_STATUS_BINS - 1]++;
+
+    VL53L0X_HistogramAdd(pStats->Latency, VL53L0X_STATS_LATENCY_BINS,
+        LATENCY_FIRST_SHIFT, LatencyUs);
+    pStats->LatencySumUs += LatencyUs;
+    if (LatencyUs > pStats->LatencyMaxUs)
+        pStats->LatencyMaxUs = LatencyUs;
+
+    pStats->AmbientSum += pData->AmbientRateRtnMegaCps;
+    pStats->SigmaSum += SigmaMilliMeter;
+
+    for (i = 0; i < VL53L0X_STATS_QUANTILES; i++) {
+        p = quantile_percent[i] / 100.0f;
+        quantile_add(&pStats->Signal[i], p,
+            pData->SignalRateRtnMegaCps / 65536.0f);
+        // out of range readings report 8190 or 8191 mm
+        if (status == 0)
+            quantile_add(&pStats->Range[i], p, pData->RangeMilliMeter);
+    }
+}
+
+void VL53L0X_StatsAddError(VL53L0X_Stats_t *pStats, VL53L0X_Error Error)
+{
+    pStats->Errors++;
+    if (Error == VL53L0X_ERROR_TIME_OUT)
+        pStats->Timeouts++;
+    else if (Error == VL53L0X_ERROR_CONTROL_INTERFACE)
+        pStats->BusErrors++;
+    pStats->LastError = Error;
+}
+
+void VL53L0X_HistogramAdd(uint32_t *pBins, uint8_t Bins, uint8_t FirstShift,
+    uint32_t LatencyUs)
+{
+    uint32_t bin = 0;
+
+    while (bin < Bins - 1u && (LatencyUs >> (bin + FirstShift)) != 0)
+        bin++;
+    pBins[bin]++;
+}
+
+uint32_t VL53L0X_HistogramPercentile(const uint32_t *pBins, uint8_t Bins,
+    uint8_t FirstShift, uint32_t MaxUs, uint8_t Percent)
+{
+    uint64_t total = 0;
+    uint64_t wanted;
+    uint64_t seen = 0;
+    uint32_t bound;
+    int bin;
+
+    for (bin = 0; bin < Bins; bin++)
+        total += pBins[bin];
+    wanted = (total * Percent + 99) / 100;
+
+    for (bin = 0; bin < Bins - 1; bin++) {
+        seen += pBins[bin];
+        if (seen >= wanted)
+            break;
+    }
+    bound = 1u << (bin + FirstShift);
+    return bin == Bins - 1 || bound > MaxUs ? MaxUs : bound;
+}
+
+uint32_t VL53L0X_StatsLatencyPercentile(const VL53L0X_Stats_t *pStats,
+    uint8_t Percent)
+{
+    return VL53L0X_HistogramPercentile(pStats->Latency,
+        VL53L0X_STATS_LATENCY_BINS, LATENCY_FIRST_SHIFT, pStats->LatencyMaxUs,
+        Percent);
+}
+
+int VL53L0X_StatsFormat(const VL53L0X_Stats_t *pStats, char *pBuffer,
+    size_t Size)
+{
+    uint32_t samples = pStats->Samples ? pStats->Samples : 1;
+    size_t length = 0;
+    int written;
+    int i;
+
+#define APPEND(...) do { \
+        written = snprintf(pBuffer + (length < Size ? length : Size), \
+            length < Size ? Size - length : 0, __VA_ARGS__); \
+        if (written > 0) \
+            length += written; \
+    } while (0)
+
+    if (Size > 0)
+        pBuffer[0] = '\0';
+
+    APPEND("samples=%u errors=%u timeouts=%u bus_errors=%u last_error=%d\n",
+        pStats->Samples, pStats->Errors, pStats->Timeouts,
+        pStats->BusErrors, pStats->LastError);
+    APPEND("status");
+    for (i = 0; i < VL53L0X_STATS_STATUS_BINS; i++)
+        APPEND(" %d%s=%u", i, i == VL53L0X_STATS_STATUS_BINS - 1 ? "+" : "",
+            pStats->Status[i]);
+    APPEND("\nrange_mm");
+    for (i = 0; i < VL53L0X_STATS_QUANTILES; i++)
+        APPEND(" p%u=%.0f", quantile_percent[i],
+            VL53L0X_StatsQuantile(&pStats->Range[i]));
+    APPEND("\nsignal_mcps");
+    for (i = 0; i < VL53L0X_STATS_QUANTILES; i++)
+        APPEND(" p%u=%.3f", quantile_percent[i],
+            VL53L0X_StatsQuantile(&pStats->Signal[i]));
+    APPEND(" ambient_mean=%.3f sigma_mm_mean=%.1f\n",
+        pStats->AmbientSum / samples / 65536.0,
+        pStats->SigmaSum / samples / 65536.0);
+    APPEND("latency_us mean=%u p50<=%u p99<=%u max=%u\n",
+        (uint32_t)(pStats->LatencySumUs / samples),
+        VL53L0X_StatsLatencyPercentile(pStats, 50),
+        VL53L0X_StatsLatencyPercentile(pStats, 99),
+        pStats->LatencyMaxUs);
+
+#undef APPEND
+
+    return (int)length;
+}
+
+void VL53L0X_GetStats(VL53L0X_DEV Dev, VL53L0X_Stats_t *pStats, uint8_t Clear)
+{
+    VL53L0X_LockDevice(Dev);
+    *pStats = Dev->ranging_stats;
+    if (Clear)
+        VL53L0X_StatsClear(&Dev->ranging_stats);
+    VL53L0X_UnlockDevice(Dev);
+}
@@ -1,3 +1,3 @@
 COMPONENT_ADD_INCLUDEDIRS := inc api/core/inc api/platform/inc
-COMPONENT_SRCDIRS := api/core/src api/platform/src
+COMPONENT_SRCDIRS := api/core/src api/platform/src src
 CFLAGS := -DUSE_I2C_2V8=1 -mlongcalls
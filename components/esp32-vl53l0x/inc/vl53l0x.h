@@ -0,0 +1,93 @@
+/**
+ * @file vl53l0x.h
+ * @brief VL53L0X driver glue for ESP-IDF, on top of the ST API: bring-up
+ * with cached calibration, single and split-phase reads, the ranging
+ * service, ranging profiles and statistics
+ */
+
+#ifndef _VL53L0X_H_
+#define _VL53L0X_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+
+#include "vl53l0x_bus_manager.h"
+#include "vl53l0x_platform.h"
+#include "vl53l0x_ranging_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  VL53L0X_READ_PENDING,
+  VL53L0X_READ_DONE,
+  VL53L0X_READ_FAILED,
+} vl53l0x_read_state_t;
+
+// ok is false for failed or invalid ranges
+typedef void (*vl53l0x_read_done_t)(void* arg, bool ok, uint16_t range_mm);
+
+typedef struct {
+  VL53L0X_Dev_t* dev;
+  uint32_t started_us;
+  uint32_t timeout_us;
+  bool pending;
+  vl53l0x_read_done_t done;
+  void* arg;
+} vl53l0x_pending_read_t;
+
+// Ranging settings applied together, see vl53l0x_set_profile()
+typedef struct {
+  const char* name;
+  uint32_t budget_us;
+  uint32_t period_ms;          // continuous timed ranging period
+  uint8_t pre_range_vcsel;     // VCSEL periods in PCLKs
+  uint8_t final_range_vcsel;
+  bool tcc;                    // sequence steps, final range is always on
+  bool msrc;
+  bool dss;
+  bool pre_range;
+  FixPoint1616_t signal_limit_mcps;
+  FixPoint1616_t sigma_limit_mm;
+} vl53l0x_profile_t;
+
+// Named ranging profiles, see vl53l0x_preset(). Sample rate against range
+// and accuracy: high-speed for presence and motion, long-range for far or
+// dark targets, high-accuracy for slowly changing distances.
+typedef enum {
+  VL53L0X_PRESET_DEFAULT,        // 33 ms budget
+  VL53L0X_PRESET_HIGH_SPEED,     // 20 ms, shorter reach and noisier
+  VL53L0X_PRESET_LONG_RANGE,     // 33 ms, up to 2 m, weak returns accepted
+  VL53L0X_PRESET_HIGH_ACCURACY,  // 200 ms, tight sigma limit
+  VL53L0X_PRESET_COUNT,
+} vl53l0x_preset_t;
+
+// Logs status with the ST error string, returns it
+VL53L0X_Error vl53l0x_print_error(VL53L0X_Error, const char*);
+bool init_vl53l0x(VL53L0X_Dev_t*, i2c_port_t, gpio_num_t, gpio_num_t, gpio_num_t);
+bool init_vl53l0x_bus(VL53L0X_Bus_t*, i2c_port_t, gpio_num_t, gpio_num_t, const gpio_num_t*, const gpio_num_t*, uint8_t);
+bool vl53l0x_read(VL53L0X_Dev_t*, uint16_t*);
+bool vl53l0x_start_read(VL53L0X_Dev_t*, vl53l0x_pending_read_t*, vl53l0x_read_done_t, void*);
+vl53l0x_read_state_t vl53l0x_poll_read(vl53l0x_pending_read_t*, uint16_t*);
+bool vl53l0x_start_ranging(VL53L0X_Dev_t*, VL53L0X_RangingService_t*, uint32_t);
+bool vl53l0x_read_latest(const VL53L0X_RangingService_t*, uint32_t, uint16_t*);
+bool vl53l0x_read_next(const VL53L0X_RangingService_t*, uint16_t*);
+bool vl53l0x_start_bus_ranging(VL53L0X_Bus_t*, uint32_t);
+void vl53l0x_print_stats(VL53L0X_Dev_t*, const char*, bool);
+void vl53l0x_print_profile(bool);
+void vl53l0x_log_bus_rate(const VL53L0X_Bus_t*);
+bool vl53l0x_set_profile(VL53L0X_Dev_t*, const vl53l0x_profile_t*);
+const vl53l0x_profile_t* vl53l0x_preset(vl53l0x_preset_t);
+const vl53l0x_profile_t* vl53l0x_preset_named(const char*);
+bool vl53l0x_start_profile(VL53L0X_Dev_t*, VL53L0X_RangingService_t*, const vl53l0x_profile_t*, uint32_t);
+bool vl53l0x_switch_profile(VL53L0X_Dev_t*, VL53L0X_RangingService_t*, const vl53l0x_profile_t*, uint32_t, uint32_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VL53L0X_H_ */
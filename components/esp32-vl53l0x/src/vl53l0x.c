@@ -0,0 +1,913 @@
+/**
+ * @file vl53l0x.c
+ * @author Ryotaro Onuki (kerikun11+github@gmail.com)
+ * @brief VL53L0X driver glue for ESP-IDF: bring-up, calibration, reads,
+ * ranging profiles and statistics, shared by the applications
+ * @date 2018-11-07
+ * @copyright Copyright (c) 2018
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+
+#include "vl53l0x_api.h"
+#include "vl53l0x_bus_manager.h"
+#include "vl53l0x_def.h"
+#include "vl53l0x_platform.h"
+#include "vl53l0x_ranging_service.h"
+
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "vl53l0x.h"
+
+static const uint8_t VL53L0X_I2C_ADDRESS_DEFAULT = 0x29;
+static const char *TAG = "VL53L0X";
+static const UBaseType_t VL53L0X_RANGING_PRIORITY = 5;
+static const uint8_t VL53L0X_BUS_FIRST_ADDRESS = 0x30;
+static const uint32_t VL53L0X_READ_TIMEOUT_MARGIN_US = 10000;
+// A transaction takes well under a millisecond at 400 kHz, the call
+// budgets cover the longest API call of each phase with a wide margin
+static const VL53L0X_BusDeadline_t VL53L0X_BUS_DEADLINES[VL53L0X_BUS_PHASES] = {
+  [VL53L0X_BUS_PHASE_INIT] = {.TransactionMs = 20, .CallMs = 500},
+  [VL53L0X_BUS_PHASE_RANGING] = {.TransactionMs = 20, .CallMs = 50},
+  [VL53L0X_BUS_PHASE_CALIBRATION] = {.TransactionMs = 20, .CallMs = 1000},
+};
+
+
+VL53L0X_Error vl53l0x_print_error(VL53L0X_Error status, const char *method) {
+  char buf[VL53L0X_MAX_STRING_LENGTH];
+  VL53L0X_GetPalErrorString(status, buf);
+  ESP_LOGE(TAG, "%s API status: %i : %s\n", method, status, buf);
+  return status;
+}
+
+// Bus traffic spent in one call site: the difference between the device
+// counters now and a snapshot taken before the call
+static void log_i2c_traffic(esp_log_level_t level, const char *site,
+                            const VL53L0X_Dev_t *vl53l0x_dev,
+                            const VL53L0X_I2cStats_t *before) {
+  const VL53L0X_I2cStats_t *now = &vl53l0x_dev->i2c_stats;
+  ESP_LOG_LEVEL_LOCAL(level, TAG,
+                      "%s: %u transactions (%u reads, %u merged writes), "
+                      "%u bytes, %u us on the bus, %u reads cached, "
+                      "%u writes skipped, %u waits for the bus (%u us)",
+                      site, now->Transactions - before->Transactions,
+                      now->ReadTransactions - before->ReadTransactions,
+                      now->MergedWrites - before->MergedWrites,
+                      (now->BytesWritten - before->BytesWritten) +
+                          (now->BytesRead - before->BytesRead),
+                      now->BusTimeUs - before->BusTimeUs,
+                      now->CachedReads - before->CachedReads,
+                      now->SkippedWrites - before->SkippedWrites,
+                      now->BusWaits - before->BusWaits,
+                      now->BusWaitUs - before->BusWaitUs);
+}
+
+// The platform keeps the pins to recover the bus after a failure
+static bool init_i2c_master(i2c_port_t i2c_port,
+                            gpio_num_t pin_sda,
+                            gpio_num_t pin_scl) {
+  uint32_t freq = 400000;
+  VL53L0X_Error status = VL53L0X_I2cInit(i2c_port, pin_sda, pin_scl, freq);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_I2cInit");
+    return false;
+  }
+  return true;
+}
+
+static void set_bus_deadlines(VL53L0X_Dev_t* vl53l0x_dev) {
+  for (uint8_t phase = 0; phase < VL53L0X_BUS_PHASES; phase++)
+    VL53L0X_SetBusDeadline(vl53l0x_dev, phase,
+                           VL53L0X_BUS_DEADLINES[phase].TransactionMs,
+                           VL53L0X_BUS_DEADLINES[phase].CallMs);
+  VL53L0X_SetBusPhase(vl53l0x_dev, VL53L0X_BUS_PHASE_INIT);
+}
+
+static bool vl53l0x_software_reset(VL53L0X_Dev_t* vl53l0x_dev) {
+  VL53L0X_Error status = VL53L0X_ResetDevice(vl53l0x_dev);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_ResetDevice");
+    return false;
+  }
+  return true;
+}
+
+// Calibration results of one module, stored in NVS under its part UID so
+// that warm boots can skip the SPAD search. The VHV/phase calibration
+// depends on the sensor's temperature, which the ESP32 cannot read: it
+// runs on every boot (~40ms) and is not stored.
+typedef struct {
+  uint32_t uid_upper;
+  uint32_t uid_lower;
+  uint8_t version;
+  uint8_t is_aperture_spads;
+  uint8_t xtalk_enable;
+  uint32_t ref_spad_count;
+  int32_t offset_um;
+  FixPoint1616_t xtalk_rate;
+} vl53l0x_calibration_t;
+
+static const char *CALIBRATION_NAMESPACE = "vl53l0x";
+static const uint8_t CALIBRATION_VERSION = 2;
+
+// NVS keys are 15 characters at most, the blobs hold the full UID
+static void uid_key(uint32_t uid_upper, uint32_t uid_lower, char *key) {
+  sprintf(key, "%07x%08x", uid_upper & 0x0FFFFFFF, uid_lower);
+}
+
+static bool load_blob(const char *name_space, const char *key, void *blob,
+                      size_t size) {
+  size_t stored = size;
+  nvs_handle_t nvs;
+  esp_err_t err;
+
+  if (nvs_open(name_space, NVS_READONLY, &nvs) != ESP_OK)
+    return false;
+  err = nvs_get_blob(nvs, key, blob, &stored);
+  nvs_close(nvs);
+  return err == ESP_OK && stored == size;
+}
+
+static void save_blob(const char *name_space, const char *key,
+                      const void *blob, size_t size, const char *what) {
+  nvs_handle_t nvs;
+  esp_err_t err;
+
+  err = nvs_open(name_space, NVS_READWRITE, &nvs);
+  if (err == ESP_OK) {
+    err = nvs_set_blob(nvs, key, blob, size);
+    if (err == ESP_OK)
+      err = nvs_commit(nvs);
+    nvs_close(nvs);
+  }
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "%s not saved: %s", what, esp_err_to_name(err));
+}
+
+static bool load_calibration(vl53l0x_calibration_t *cal) {
+  vl53l0x_calibration_t stored;
+  char key[16];
+
+  uid_key(cal->uid_upper, cal->uid_lower, key);
+  if (!load_blob(CALIBRATION_NAMESPACE, key, &stored, sizeof(stored)) ||
+      stored.version != CALIBRATION_VERSION ||
+      stored.uid_upper != cal->uid_upper ||
+      stored.uid_lower != cal->uid_lower)
+    return false;
+  *cal = stored;
+  return true;
+}
+
+static void save_calibration(const vl53l0x_calibration_t *cal) {
+  char key[16];
+
+  uid_key(cal->uid_upper, cal->uid_lower, key);
+  save_blob(CALIBRATION_NAMESPACE, key, cal, sizeof(*cal), "calibration");
+}
+
+// Factory data the API reads from the sensor's NVM, one strobe per word.
+// Stored under the part UID like the calibration: a later boot reads only
+// the UID words and takes the rest from NVS.
+typedef struct {
+  uint8_t version;
+  VL53L0X_DeviceInfoCache_t nvm;
+} vl53l0x_device_info_t;
+
+static const char *DEVICE_INFO_NAMESPACE = "vl53l0x_nvm";
+static const uint8_t DEVICE_INFO_VERSION = 1;
+
+static bool load_device_info(uint32_t uid_upper, uint32_t uid_lower,
+                             vl53l0x_device_info_t *info) {
+  char key[16];
+
+  uid_key(uid_upper, uid_lower, key);
+  return load_blob(DEVICE_INFO_NAMESPACE, key, info, sizeof(*info)) &&
+         info->version == DEVICE_INFO_VERSION &&
+         info->nvm.PartUIDUpper == uid_upper &&
+         info->nvm.PartUIDLower == uid_lower;
+}
+
+static void save_device_info(const vl53l0x_device_info_t *info) {
+  char key[16];
+
+  uid_key(info->nvm.PartUIDUpper, info->nvm.PartUIDLower, key);
+  save_blob(DEVICE_INFO_NAMESPACE, key, info, sizeof(*info), "NVM data");
+}
+
+// Temperature calibration (~40ms), at the temperature the sensor has now
+static VL53L0X_Error calibrate_temperature(VL53L0X_Dev_t *pDevice) {
+  VL53L0X_Error status;
+  uint8_t vhv_settings, phase_cal;
+  VL53L0X_SetBusPhase(pDevice, VL53L0X_BUS_PHASE_CALIBRATION);
+  VL53L0X_BeginCall(pDevice, 0);
+  status = VL53L0X_PerformRefCalibration(pDevice, &vhv_settings, &phase_cal);
+  VL53L0X_EndCall(pDevice);
+  VL53L0X_SetBusPhase(pDevice, VL53L0X_BUS_PHASE_INIT);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_PerformRefCalibration");
+  return status;
+}
+
+static VL53L0X_Error restore_calibration(VL53L0X_Dev_t *pDevice,
+                                         const vl53l0x_calibration_t *cal) {
+  VL53L0X_Error status;
+  status = VL53L0X_SetReferenceSpads(pDevice, cal->ref_spad_count,
+                                     cal->is_aperture_spads);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_SetReferenceSpads");
+  status = calibrate_temperature(pDevice);
+  if (status != VL53L0X_ERROR_NONE)
+    return status;
+  status = VL53L0X_SetOffsetCalibrationDataMicroMeter(pDevice, cal->offset_um);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status,
+                               "VL53L0X_SetOffsetCalibrationDataMicroMeter");
+  status = VL53L0X_SetXTalkCompensationRateMegaCps(pDevice, cal->xtalk_rate);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetXTalkCompensationEnable(pDevice, cal->xtalk_enable);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_SetXTalkCompensation");
+  return status;
+}
+
+static VL53L0X_Error perform_calibration(VL53L0X_Dev_t *pDevice,
+                                         vl53l0x_calibration_t *cal) {
+  VL53L0X_Error status;
+  VL53L0X_SetBusPhase(pDevice, VL53L0X_BUS_PHASE_CALIBRATION);
+  // SPADs calibration: one reference measurement checks the SPADs
+  // StaticInit applied from the sensor's NVM, the full search (~10
+  // measurements) only runs when they miss the target rate
+  VL53L0X_BeginCall(pDevice, 0);
+  status = VL53L0X_PerformFastRefSpadManagement(
+      pDevice, &cal->ref_spad_count, &cal->is_aperture_spads);
+  VL53L0X_EndCall(pDevice);
+  ESP_LOGI(TAG, "refSpadCount = %d, isApertureSpads = %d\n",
+           cal->ref_spad_count, cal->is_aperture_spads);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_PerformFastRefSpadManagement");
+  status = calibrate_temperature(pDevice);
+  if (status != VL53L0X_ERROR_NONE)
+    return status;
+  status = VL53L0X_GetOffsetCalibrationDataMicroMeter(pDevice,
+                                                      &cal->offset_um);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_GetXTalkCompensationEnable(pDevice, &cal->xtalk_enable);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_GetXTalkCompensationRateMegaCps(pDevice,
+                                                     &cal->xtalk_rate);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_GetCalibrationData");
+  return status;
+}
+
+static VL53L0X_Error _init_vl53l0x(VL53L0X_Dev_t *pDevice) {
+  VL53L0X_Error status;
+  vl53l0x_calibration_t cal;
+  vl53l0x_device_info_t info;
+  uint32_t uid_upper, uid_lower;
+  bool info_cached;
+  // Device Initialization (~40ms)
+  VL53L0X_BeginCall(pDevice, 0);
+  status = VL53L0X_DataInit(pDevice);
+  VL53L0X_EndCall(pDevice);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_DataInit");
+  // NVM data, from NVS when the UID says this module was seen before
+  status = VL53L0X_ReadPartUID(pDevice, &uid_upper, &uid_lower);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_ReadPartUID");
+  info_cached = load_device_info(uid_upper, uid_lower, &info);
+  if (info_cached) {
+    status = VL53L0X_SetDeviceInfoCache(pDevice, &info.nvm);
+    if (status != VL53L0X_ERROR_NONE)
+      return vl53l0x_print_error(status, "VL53L0X_SetDeviceInfoCache");
+  }
+  VL53L0X_BeginCall(pDevice, 0);
+  status = VL53L0X_StaticInit(pDevice);
+  VL53L0X_EndCall(pDevice);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_StaticInit");
+  if (!info_cached) {
+    memset(&info, 0, sizeof(info));
+    info.version = DEVICE_INFO_VERSION;
+    status = VL53L0X_GetDeviceInfoCache(pDevice, &info.nvm);
+    if (status != VL53L0X_ERROR_NONE)
+      return vl53l0x_print_error(status, "VL53L0X_GetDeviceInfoCache");
+    save_device_info(&info);
+  }
+  // Calibration, from NVS when this module was calibrated before
+  memset(&cal, 0, sizeof(cal));
+  cal.uid_upper = uid_upper;
+  cal.uid_lower = uid_lower;
+  cal.version = CALIBRATION_VERSION;
+  if (load_calibration(&cal)) {
+    ESP_LOGI(TAG, "calibration restored for %08x%08x", cal.uid_upper,
+             cal.uid_lower);
+    status = restore_calibration(pDevice, &cal);
+  } else {
+    status = perform_calibration(pDevice, &cal);
+    if (status == VL53L0X_ERROR_NONE)
+      save_calibration(&cal);
+  }
+  if (status != VL53L0X_ERROR_NONE)
+    return status;
+  // Setup in single ranging mode
+  status = VL53L0X_SetDeviceMode(pDevice, VL53L0X_DEVICEMODE_SINGLE_RANGING);
+  if (status != VL53L0X_ERROR_NONE)
+    return vl53l0x_print_error(status, "VL53L0X_SetDeviceMode");
+  // end
+  return status;
+}
+
+static bool vl53l0x_set_time_budget(VL53L0X_Dev_t* vl53l0x_dev,
+                                    uint32_t TimingBudgetMicroSeconds) {
+  VL53L0X_Error status = VL53L0X_SetMeasurementTimingBudgetMicroSeconds(
+      vl53l0x_dev, TimingBudgetMicroSeconds);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status,
+                        "VL53L0X_SetMeasurementTimingBudgetMicroSeconds");
+    return false;
+  }
+  // this->TimingBudgetMicroSeconds = TimingBudgetMicroSeconds;
+  return true;
+}
+
+static bool vl53l0x_set_interrupt_pin(VL53L0X_Dev_t* vl53l0x_dev,
+                                      gpio_num_t pin_gpio1) {
+  VL53L0X_Error status = VL53L0X_SetInterruptPin(
+      vl53l0x_dev, pin_gpio1, VL53L0X_INTERRUPTPOLARITY_LOW);
+  if (status != VL53L0X_ERROR_NONE) {
+    // not fatal, data ready is polled over I2C instead
+    vl53l0x_print_error(status, "VL53L0X_SetInterruptPin");
+    return false;
+  }
+  if (pin_gpio1 != GPIO_NUM_MAX)
+    ESP_LOGI(TAG, "data ready interrupt on GPIO%d", pin_gpio1);
+  return true;
+}
+
+// Ranging service reinit, device locked and stopped: the sensor as
+// init_vl53l0x_device() left it, or with the profile that was running
+static VL53L0X_Error reinit_vl53l0x(VL53L0X_DEV vl53l0x_dev, void* arg) {
+  const vl53l0x_profile_t* profile = (const vl53l0x_profile_t*)arg;
+  VL53L0X_Error status = VL53L0X_ERROR_NONE;
+  ESP_LOGW(TAG, "reinitializing the sensor at 0x%02x",
+           vl53l0x_dev->i2c_address);
+  VL53L0X_SetBusPhase(vl53l0x_dev, VL53L0X_BUS_PHASE_INIT);
+  // a software reset goes back to the default address, keep bus sensors
+  // where VL53L0X_BusAssignAddresses() put them
+  if (vl53l0x_dev->i2c_address == VL53L0X_I2C_ADDRESS_DEFAULT)
+    status = VL53L0X_ResetDevice(vl53l0x_dev);
+  if (status == VL53L0X_ERROR_NONE)
+    status = _init_vl53l0x(vl53l0x_dev);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetGpioConfig(vl53l0x_dev, 0,
+                                   VL53L0X_DEVICEMODE_SINGLE_RANGING,
+                                   VL53L0X_GPIOFUNCTIONALITY_NEW_MEASURE_READY,
+                                   VL53L0X_INTERRUPTPOLARITY_LOW);
+  if (status != VL53L0X_ERROR_NONE)
+    return status;
+  if (profile != NULL)
+    return vl53l0x_set_profile(vl53l0x_dev, profile) ? VL53L0X_ERROR_NONE
+                                                     : VL53L0X_ERROR_UNDEFINED;
+  return vl53l0x_set_time_budget(vl53l0x_dev, 33000) ? VL53L0X_ERROR_NONE
+                                                     : VL53L0X_ERROR_UNDEFINED;
+}
+
+// Everything after the device answers at its final address
+static bool init_vl53l0x_device(VL53L0X_Dev_t* vl53l0x_dev,
+                                gpio_num_t pin_gpio1) {
+  VL53L0X_I2cStats_t before = vl53l0x_dev->i2c_stats;
+
+  // before the device is shared with other tasks
+  if (VL53L0X_CreateLocks(vl53l0x_dev) != VL53L0X_ERROR_NONE)
+    return false;
+  set_bus_deadlines(vl53l0x_dev);
+  if (_init_vl53l0x(vl53l0x_dev) != VL53L0X_ERROR_NONE)
+    return false;
+  log_i2c_traffic(ESP_LOG_INFO, "init", vl53l0x_dev, &before);
+#ifdef VL53L0X_TRACE_BINARY
+  // decode with components/esp32-vl53l0x/tools/vl53l0x_trace_decode.py
+  VL53L0X_trace_dump();
+  VL53L0X_trace_clear();
+#elif defined(VL53L0X_TRACE_PROFILE)
+  // what init cost per API function, the table then starts over for ranging
+  VL53L0X_profile_dump();
+  VL53L0X_profile_clear();
+#endif
+  if (VL53L0X_ERROR_NONE !=
+      VL53L0X_SetGpioConfig(vl53l0x_dev, 0,
+                            VL53L0X_DEVICEMODE_SINGLE_RANGING,
+                            VL53L0X_GPIOFUNCTIONALITY_NEW_MEASURE_READY,
+                            VL53L0X_INTERRUPTPOLARITY_LOW))
+    return false;
+  vl53l0x_set_interrupt_pin(vl53l0x_dev, pin_gpio1);
+  if (!vl53l0x_set_time_budget(vl53l0x_dev, 33000))
+    return false;
+  VL53L0X_SetBusPhase(vl53l0x_dev, VL53L0X_BUS_PHASE_RANGING);
+  return true;
+}
+
+// pin_gpio1: host pin wired to the sensor's GPIO1, GPIO_NUM_MAX to poll
+bool init_vl53l0x(VL53L0X_Dev_t* vl53l0x_dev,
+                  i2c_port_t i2c_port,
+                  gpio_num_t pin_sda,
+                  gpio_num_t pin_scl,
+                  gpio_num_t pin_gpio1) {
+  if (!init_i2c_master(i2c_port, pin_sda, pin_scl))
+    return false;
+  memset(vl53l0x_dev, 0, sizeof(*vl53l0x_dev));
+  vl53l0x_dev->i2c_port_num = i2c_port;
+  vl53l0x_dev->i2c_address = VL53L0X_I2C_ADDRESS_DEFAULT;
+  VL53L0X_SetShadowEnable(vl53l0x_dev, 1);
+  vl53l0x_software_reset(vl53l0x_dev);
+  return init_vl53l0x_device(vl53l0x_dev, pin_gpio1);
+}
+
+// Several sensors on one port, each with its XSHUT pin wired to the host.
+// Sensor i ends up at VL53L0X_BUS_FIRST_ADDRESS + i. pins_gpio1 may be NULL
+// to poll all of them.
+bool init_vl53l0x_bus(VL53L0X_Bus_t* bus,
+                      i2c_port_t i2c_port,
+                      gpio_num_t pin_sda,
+                      gpio_num_t pin_scl,
+                      const gpio_num_t* pins_xshut,
+                      const gpio_num_t* pins_gpio1,
+                      uint8_t count) {
+  if (!init_i2c_master(i2c_port, pin_sda, pin_scl))
+    return false;
+  VL53L0X_Error status = VL53L0X_BusAssignAddresses(
+      bus, i2c_port, pins_xshut, count, VL53L0X_BUS_FIRST_ADDRESS);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_BusAssignAddresses");
+    return false;
+  }
+  for (int i = 0; i < count; i++) {
+    VL53L0X_Dev_t* vl53l0x_dev = &bus->Sensors[i].Dev;
+    // fresh out of XSHUT reset, a software reset would only cost time
+    VL53L0X_SetShadowEnable(vl53l0x_dev, 1);
+    if (!init_vl53l0x_device(vl53l0x_dev,
+                             pins_gpio1 ? pins_gpio1[i] : GPIO_NUM_MAX)) {
+      ESP_LOGE(TAG, "sensor %d at 0x%02x failed to initialize", i,
+               vl53l0x_dev->i2c_address);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Folds a measurement read by the application into the device statistics,
+// device lock held
+static void add_stats(VL53L0X_Dev_t* vl53l0x_dev, VL53L0X_Error status,
+                      const VL53L0X_RangingMeasurementData_t* data,
+                      uint32_t started_us) {
+  FixPoint1616_t sigma = 0;
+  if (status != VL53L0X_ERROR_NONE) {
+    VL53L0X_StatsAddError(&vl53l0x_dev->ranging_stats, status);
+    return;
+  }
+  VL53L0X_GetLimitCheckCurrent(vl53l0x_dev,
+                               VL53L0X_CHECKENABLE_SIGMA_FINAL_RANGE, &sigma);
+  VL53L0X_StatsAddSample(&vl53l0x_dev->ranging_stats, data, sigma,
+                         VL53L0X_GetTickCountUs() - started_us);
+}
+
+bool vl53l0x_read(VL53L0X_Dev_t* vl53l0x_dev, uint16_t* pRangeMilliMeter) {
+  VL53L0X_RangingMeasurementData_t MeasurementData;
+  VL53L0X_I2cStats_t before = vl53l0x_dev->i2c_stats;
+  uint32_t started_us = VL53L0X_GetTickCountUs();
+  uint32_t budget_us = 0;
+  VL53L0X_LockDevice(vl53l0x_dev);
+  // blocks for the measurement, on top of the readout
+  VL53L0X_GetMeasurementTimingBudgetMicroSeconds(vl53l0x_dev, &budget_us);
+  VL53L0X_BeginCall(vl53l0x_dev,
+                    (2 * budget_us + VL53L0X_READ_TIMEOUT_MARGIN_US) / 1000);
+  VL53L0X_Error status = VL53L0X_PerformFastSingleRangingMeasurement(
+      vl53l0x_dev, &MeasurementData);
+  VL53L0X_EndCall(vl53l0x_dev);
+  add_stats(vl53l0x_dev, status, &MeasurementData, started_us);
+  VL53L0X_UnlockDevice(vl53l0x_dev);
+  log_i2c_traffic(ESP_LOG_DEBUG, "read", vl53l0x_dev, &before);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_PerformFastSingleRangingMeasurement");
+    return false;
+  }
+  *pRangeMilliMeter = MeasurementData.RangeMilliMeter;
+  if (MeasurementData.RangeStatus != 0)
+    return false;
+  return true;
+}
+
+// Split-phase single measurement: vl53l0x_start_read() starts the sensor
+// and returns at once, vl53l0x_poll_read() collects the result when the
+// sensor has it, so the caller can do other work for the timing budget.
+// Not for a device that runs a ranging service.
+bool vl53l0x_start_read(VL53L0X_Dev_t* vl53l0x_dev,
+                        vl53l0x_pending_read_t* read,
+                        vl53l0x_read_done_t done,
+                        void* arg) {
+  uint32_t budget_us = 0;
+  VL53L0X_Error status;
+  memset(read, 0, sizeof(*read));
+  read->dev = vl53l0x_dev;
+  read->done = done;
+  read->arg = arg;
+  VL53L0X_GetMeasurementTimingBudgetMicroSeconds(vl53l0x_dev, &budget_us);
+  // the measurement itself takes the budget, allow as much again for readout
+  read->timeout_us = 2 * budget_us + VL53L0X_READ_TIMEOUT_MARGIN_US;
+  VL53L0X_LockDevice(vl53l0x_dev);
+  status = VL53L0X_SetDeviceMode(vl53l0x_dev, VL53L0X_DEVICEMODE_SINGLE_RANGING);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_StartMeasurement(vl53l0x_dev);
+  VL53L0X_UnlockDevice(vl53l0x_dev);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_StartMeasurement");
+    return false;
+  }
+  read->started_us = VL53L0X_GetTickCountUs();
+  read->pending = true;
+  return true;
+}
+
+static vl53l0x_read_state_t finish_read(vl53l0x_pending_read_t* read,
+                                        vl53l0x_read_state_t state,
+                                        uint16_t range_mm) {
+  read->pending = false;
+  if (read->done)
+    read->done(read->arg, state == VL53L0X_READ_DONE, range_mm);
+  return state;
+}
+
+// Never blocks. VL53L0X_READ_PENDING until the measurement is in, then
+// VL53L0X_READ_DONE or VL53L0X_READ_FAILED exactly once, calling the
+// completion callback (if any) from the polling task.
+vl53l0x_read_state_t vl53l0x_poll_read(vl53l0x_pending_read_t* read,
+                                       uint16_t* pRangeMilliMeter) {
+  VL53L0X_RangingMeasurementData_t MeasurementData;
+  uint8_t ready = 0;
+  VL53L0X_Error status;
+
+  if (!read->pending)
+    return VL53L0X_READ_FAILED;
+
+  VL53L0X_LockDevice(read->dev);
+  VL53L0X_BeginCall(read->dev, 0);
+  // one burst checks data ready and reads the result, one write clears
+  status = VL53L0X_GetRangingMeasurementDataFast(read->dev, &MeasurementData,
+                                                 0, &ready);
+  if (status == VL53L0X_ERROR_NONE && !ready) {
+    VL53L0X_EndCall(read->dev);
+    if (VL53L0X_GetTickCountUs() - read->started_us <= read->timeout_us) {
+      VL53L0X_UnlockDevice(read->dev);
+      return VL53L0X_READ_PENDING;
+    }
+    add_stats(read->dev, VL53L0X_ERROR_TIME_OUT, NULL, read->started_us);
+    VL53L0X_UnlockDevice(read->dev);
+    vl53l0x_print_error(VL53L0X_ERROR_TIME_OUT, "vl53l0x_poll_read");
+    return finish_read(read, VL53L0X_READ_FAILED, 0);
+  }
+  VL53L0X_EndCall(read->dev);
+  add_stats(read->dev, status, &MeasurementData, read->started_us);
+  VL53L0X_UnlockDevice(read->dev);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "vl53l0x_poll_read");
+    return finish_read(read, VL53L0X_READ_FAILED, 0);
+  }
+
+  *pRangeMilliMeter = MeasurementData.RangeMilliMeter;
+  return finish_read(read,
+                     MeasurementData.RangeStatus == 0 ? VL53L0X_READ_DONE
+                                                      : VL53L0X_READ_FAILED,
+                     MeasurementData.RangeMilliMeter);
+}
+
+bool vl53l0x_start_ranging(VL53L0X_Dev_t* vl53l0x_dev,
+                           VL53L0X_RangingService_t* service,
+                           uint32_t period_ms) {
+  VL53L0X_Error status = VL53L0X_StartRangingService(
+      service, vl53l0x_dev, period_ms, VL53L0X_RANGING_PRIORITY);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_StartRangingService");
+    return false;
+  }
+  VL53L0X_SetRangingReinit(service, reinit_vl53l0x, NULL);
+  return true;
+}
+
+// period_ms, or the profile's own period when that is 0 or shorter
+static uint32_t profile_period(const vl53l0x_profile_t* profile,
+                               uint32_t period_ms) {
+  return period_ms > profile->period_ms ? period_ms : profile->period_ms;
+}
+
+// VL53L0X_ConfigureFunc_t of vl53l0x_switch_profile()
+static VL53L0X_Error apply_profile(VL53L0X_DEV vl53l0x_dev, void* arg) {
+  return vl53l0x_set_profile(vl53l0x_dev, (const vl53l0x_profile_t*)arg)
+             ? VL53L0X_ERROR_NONE
+             : VL53L0X_ERROR_UNDEFINED;
+}
+
+// Service not running. Ranges every period_ms, or at the profile's own
+// period when that is 0 or shorter; a reinit in the background brings the
+// profile back as well.
+bool vl53l0x_start_profile(VL53L0X_Dev_t* vl53l0x_dev,
+                           VL53L0X_RangingService_t* service,
+                           const vl53l0x_profile_t* profile,
+                           uint32_t period_ms) {
+  bool ok;
+  VL53L0X_LockDevice(vl53l0x_dev);
+  ok = vl53l0x_set_profile(vl53l0x_dev, profile);
+  VL53L0X_UnlockDevice(vl53l0x_dev);
+  if (!ok || !vl53l0x_start_ranging(vl53l0x_dev, service,
+                                    profile_period(profile, period_ms)))
+    return false;
+  VL53L0X_SetRangingReinit(service, reinit_vl53l0x, (void*)profile);
+  ESP_LOGD(TAG, "sensor at 0x%02x: %s profile", vl53l0x_dev->i2c_address,
+           profile->name);
+  return true;
+}
+
+// The same while service runs, in place: the task keeps running, the
+// sensor is stopped, set up and restarted under the device lock. Sample
+// numbers go on, from *first_sample (if not NULL) on they were read out
+// with the new profile. Starts the service if it is not running.
+bool vl53l0x_switch_profile(VL53L0X_Dev_t* vl53l0x_dev,
+                            VL53L0X_RangingService_t* service,
+                            const vl53l0x_profile_t* profile,
+                            uint32_t period_ms,
+                            uint32_t* first_sample) {
+  VL53L0X_Error status;
+  if (service->Task == NULL) {
+    if (first_sample)
+      *first_sample = 0;
+    return vl53l0x_start_profile(vl53l0x_dev, service, profile, period_ms);
+  }
+  // a reinit brings the new profile back, also after a failed switch
+  VL53L0X_SetRangingReinit(service, reinit_vl53l0x, (void*)profile);
+  status = VL53L0X_ReconfigureRangingService(
+      service, profile_period(profile, period_ms), apply_profile,
+      (void*)profile, first_sample);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_ReconfigureRangingService");
+    return false;
+  }
+  ESP_LOGD(TAG, "sensor at 0x%02x: %s profile", vl53l0x_dev->i2c_address,
+           profile->name);
+  return true;
+}
+
+bool vl53l0x_start_bus_ranging(VL53L0X_Bus_t* bus, uint32_t period_ms) {
+  VL53L0X_Error status =
+      VL53L0X_BusStartRanging(bus, period_ms, VL53L0X_RANGING_PRIORITY);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "VL53L0X_BusStartRanging");
+    return false;
+  }
+  return true;
+}
+
+void vl53l0x_log_bus_rate(const VL53L0X_Bus_t* bus) {
+  FixPoint1616_t rate;
+  if (VL53L0X_BusGetSampleRate(bus, &rate) != VL53L0X_ERROR_NONE)
+    return;
+  ESP_LOGI(TAG, "%d sensors: %u.%02u samples/s", bus->Ranging, rate >> 16,
+           ((rate & 0xffff) * 100) >> 16);
+}
+
+// Statistics of one device on the console (UART0), clear to start over
+void vl53l0x_print_stats(VL53L0X_Dev_t* vl53l0x_dev, const char* name,
+                         bool clear) {
+  char text[384];
+  VL53L0X_Stats_t stats;
+  VL53L0X_GetStats(vl53l0x_dev, &stats, clear);
+  VL53L0X_StatsFormat(&stats, text, sizeof(text));
+  printf("vl53l0x %s at 0x%02x\n%s", name, vl53l0x_dev->i2c_address, text);
+  const VL53L0X_I2cStats_t* bus = &vl53l0x_dev->i2c_stats;
+  printf("bus_us p50<=%u p99<=%u max=%u deadline_misses=%u "
+         "budget_refusals=%u\n",
+         VL53L0X_HistogramPercentile(bus->Latency, VL53L0X_I2C_LATENCY_BINS,
+                                     VL53L0X_I2C_LATENCY_SHIFT,
+                                     bus->LatencyMaxUs, 50),
+         VL53L0X_HistogramPercentile(bus->Latency, VL53L0X_I2C_LATENCY_BINS,
+                                     VL53L0X_I2C_LATENCY_SHIFT,
+                                     bus->LatencyMaxUs, 99),
+         bus->LatencyMaxUs, bus->DeadlineMisses, bus->BudgetRefusals);
+  printf("bus_recoveries=%u sda_clears=%u recovery_failures=%u\n",
+         bus->BusRecoveries, bus->SdaClears, bus->RecoveryFailures);
+  if (bus->Samples > 0)
+    printf("bus_tx_per_sample=%u.%02u over %u samples\n",
+           bus->SampleTransactions / bus->Samples,
+           bus->SampleTransactions % bus->Samples * 100 / bus->Samples,
+           bus->Samples);
+}
+
+// Bus traffic per ST API function, all devices together, on the console
+void vl53l0x_print_profile(bool clear) {
+#ifdef VL53L0X_TRACE_PROFILE
+  VL53L0X_profile_dump();
+  if (clear)
+    VL53L0X_profile_clear();
+#else
+  printf("vl53l0x profile: select I2C traffic per function in menuconfig "
+         "(VL53L0X -> API call tracing)\n");
+#endif
+}
+
+static bool sample_range(const VL53L0X_RangingSample_t* sample,
+                         uint16_t* pRangeMilliMeter) {
+  *pRangeMilliMeter = sample->Data.RangeMilliMeter;
+  return sample->Data.RangeStatus == 0;
+}
+
+// Newest sample of a running service, never touches the bus. False when
+// nothing was published for max_age_ms (service stopped or failing).
+bool vl53l0x_read_latest(const VL53L0X_RangingService_t* service,
+                         uint32_t max_age_ms,
+                         uint16_t* pRangeMilliMeter) {
+  VL53L0X_RangingSample_t sample;
+  if (VL53L0X_GetLatestRanging(service, &sample) != VL53L0X_ERROR_NONE)
+    return false;
+  // measured, not published, that long ago
+  if (VL53L0X_GetTickCountUs() - sample.Data.TimeStamp > max_age_ms * 1000)
+    return false;
+  return sample_range(&sample, pRangeMilliMeter);
+}
+
+// First sample measured entirely after the call, waits up to three periods.
+// False as well when the service restarts meanwhile.
+bool vl53l0x_read_next(const VL53L0X_RangingService_t* service,
+                       uint16_t* pRangeMilliMeter) {
+  VL53L0X_RangingSample_t sample;
+  uint32_t generation = VL53L0X_GetRangingGeneration(service);
+  // the sample in progress may have started before the call
+  uint32_t number = VL53L0X_GetRangingCount(service) + 1;
+  uint32_t waited_ms = 0;
+  while (VL53L0X_GetRangingCount(service) <= number) {
+    if (waited_ms > 3 * service->PeriodMs ||
+        VL53L0X_GetRangingGeneration(service) != generation)
+      return false;
+    vTaskDelay(10 / portTICK_RATE_MS);
+    waited_ms += 10;
+  }
+  if (VL53L0X_GetRangingSample(service, number, &sample) != VL53L0X_ERROR_NONE)
+    return false;
+  return sample_range(&sample, pRangeMilliMeter);
+}
+
+// Named presets, ST's settings for the VL53L0X use cases (UM2039). Rates
+// are for continuous timed ranging at period_ms, accuracy for a white
+// target indoors; see vl53l0x_preset_t for when to use which.
+static const vl53l0x_profile_t VL53L0X_PRESETS[VL53L0X_PRESET_COUNT] = {
+    // ~26 Hz, 1.2 m, +-4 %: what init_vl53l0x() leaves
+    [VL53L0X_PRESET_DEFAULT] = {
+        .name = "default",
+        .budget_us = 33000,
+        .period_ms = 38,
+        .pre_range_vcsel = 14,
+        .final_range_vcsel = 10,
+        .tcc = true,
+        .msrc = true,
+        .dss = true,
+        .pre_range = true,
+        .signal_limit_mcps = (FixPoint1616_t)(0.25 * 65536),
+        .sigma_limit_mm = (FixPoint1616_t)(18 * 65536),
+    },
+    // ~40 Hz, 1.2 m, +-5 %: the minimum budget, TCC dropped so the final
+    // range keeps most of it, sigma limit relaxed for the noisier samples
+    [VL53L0X_PRESET_HIGH_SPEED] = {
+        .name = "high-speed",
+        .budget_us = 20000,
+        .period_ms = 25,
+        .pre_range_vcsel = 14,
+        .final_range_vcsel = 10,
+        .tcc = false,
+        .msrc = true,
+        .dss = true,
+        .pre_range = true,
+        .signal_limit_mcps = (FixPoint1616_t)(0.25 * 65536),
+        .sigma_limit_mm = (FixPoint1616_t)(32 * 65536),
+    },
+    // ~26 Hz, 2 m in the dark (less under ambient light), +-5 % at best:
+    // longer VCSEL periods and a low signal limit accept weak returns, at
+    // the cost of more invalid or noisy ranges in daylight
+    [VL53L0X_PRESET_LONG_RANGE] = {
+        .name = "long-range",
+        .budget_us = 33000,
+        .period_ms = 38,
+        .pre_range_vcsel = 18,
+        .final_range_vcsel = 14,
+        .tcc = true,
+        .msrc = true,
+        .dss = true,
+        .pre_range = true,
+        .signal_limit_mcps = (FixPoint1616_t)(0.1 * 65536),
+        .sigma_limit_mm = (FixPoint1616_t)(60 * 65536),
+    },
+    // ~5 Hz, 1.2 m, +-3 %: six times the default budget averages the
+    // noise down
+    [VL53L0X_PRESET_HIGH_ACCURACY] = {
+        .name = "high-accuracy",
+        .budget_us = 200000,
+        .period_ms = 205,
+        .pre_range_vcsel = 14,
+        .final_range_vcsel = 10,
+        .tcc = true,
+        .msrc = true,
+        .dss = true,
+        .pre_range = true,
+        .signal_limit_mcps = (FixPoint1616_t)(0.25 * 65536),
+        .sigma_limit_mm = (FixPoint1616_t)(18 * 65536),
+    },
+};
+
+const vl53l0x_profile_t* vl53l0x_preset(vl53l0x_preset_t preset) {
+  if (preset >= VL53L0X_PRESET_COUNT)
+    return NULL;
+  return &VL53L0X_PRESETS[preset];
+}
+
+// NULL if no preset is called exactly name
+const vl53l0x_profile_t* vl53l0x_preset_named(const char* name) {
+  for (int i = 0; i < VL53L0X_PRESET_COUNT; i++) {
+    if (strcmp(name, VL53L0X_PRESETS[i].name) == 0)
+      return &VL53L0X_PRESETS[i];
+  }
+  return NULL;
+}
+
+// Device locked and not ranging. The budget goes last, it is spread over
+// the enabled steps at their VCSEL periods; a larger one goes first as
+// well, the old one may be too short for the steps to enable. The writes
+// go out batched, reads in between flush them.
+bool vl53l0x_set_profile(VL53L0X_Dev_t* vl53l0x_dev,
+                         const vl53l0x_profile_t* profile) {
+  const struct {
+    VL53L0X_SequenceStepId step;
+    bool enable;
+  } steps[] = {
+      {VL53L0X_SEQUENCESTEP_TCC, profile->tcc},
+      {VL53L0X_SEQUENCESTEP_MSRC, profile->msrc},
+      {VL53L0X_SEQUENCESTEP_DSS, profile->dss},
+      {VL53L0X_SEQUENCESTEP_PRE_RANGE, profile->pre_range},
+      {VL53L0X_SEQUENCESTEP_FINAL_RANGE, true},
+  };
+  const struct {
+    VL53L0X_VcselPeriod type;
+    uint8_t pclks;
+  } vcsel[] = {
+      {VL53L0X_VCSEL_PERIOD_PRE_RANGE, profile->pre_range_vcsel},
+      {VL53L0X_VCSEL_PERIOD_FINAL_RANGE, profile->final_range_vcsel},
+  };
+  VL53L0X_Error status = VL53L0X_ERROR_NONE;
+  VL53L0X_Error batch_status;
+  uint32_t budget_us;
+  uint8_t pclks;
+
+  VL53L0X_GETPARAMETERFIELD(vl53l0x_dev, MeasurementTimingBudgetMicroSeconds,
+                            budget_us);
+  VL53L0X_BeginWriteBatch(vl53l0x_dev);
+  if (profile->budget_us > budget_us)
+    status = VL53L0X_SetMeasurementTimingBudgetMicroSeconds(
+        vl53l0x_dev, profile->budget_us);
+  for (int i = 0; i < sizeof(steps) / sizeof(steps[0]) &&
+                  status == VL53L0X_ERROR_NONE; i++)
+    status = VL53L0X_SetSequenceStepEnable(vl53l0x_dev, steps[i].step,
+                                           steps[i].enable);
+  // only on change, each new period runs a phase calibration
+  for (int i = 0; i < sizeof(vcsel) / sizeof(vcsel[0]) &&
+                  status == VL53L0X_ERROR_NONE; i++) {
+    status = VL53L0X_GetVcselPulsePeriod(vl53l0x_dev, vcsel[i].type, &pclks);
+    if (status == VL53L0X_ERROR_NONE && pclks != vcsel[i].pclks)
+      status = VL53L0X_SetVcselPulsePeriod(vl53l0x_dev, vcsel[i].type,
+                                           vcsel[i].pclks);
+  }
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetLimitCheckValue(
+        vl53l0x_dev, VL53L0X_CHECKENABLE_SIGNAL_RATE_FINAL_RANGE,
+        profile->signal_limit_mcps);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetLimitCheckValue(vl53l0x_dev,
+                                        VL53L0X_CHECKENABLE_SIGMA_FINAL_RANGE,
+                                        profile->sigma_limit_mm);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetMeasurementTimingBudgetMicroSeconds(
+        vl53l0x_dev, profile->budget_us);
+  batch_status = VL53L0X_EndWriteBatch(vl53l0x_dev);
+  if (status == VL53L0X_ERROR_NONE)
+    status = batch_status;
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "vl53l0x_set_profile");
+    return false;
+  }
+  return true;
+}
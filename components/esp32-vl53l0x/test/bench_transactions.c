@@ -0,0 +1,154 @@
+/*
+ * Bus transactions and simulated bus time of the VL53L0X call sequences
+ * the apps use: bring-up, SPAD management and one ranging sample in each
+ * readout path. The register model counts every transaction the platform
+ * layer sends, the clock advances with bus bits at 400 kHz plus a fixed
+ * cost per transaction, so the numbers compare bus optimizations without
+ * a board. Data ready is polled (every 1 ms) or signalled on
+ * GPIO1.
+ */
+#include "vl53l0x_test.h"
+
+#define SAMPLES 20
+
+static VL53L0X_SimDevice_t sensor;
+static VL53L0X_Dev_t dev;
+static VL53L0X_I2cStats_t mark;
+static uint32_t mark_us;
+
+static void start(void)
+{
+    mark = dev.i2c_stats;
+    mark_us = VL53L0X_GetTickCountUs();
+}
+
+static void report(const char *name, uint32_t samples)
+{
+    uint32_t tx = dev.i2c_stats.Transactions - mark.Transactions;
+    uint32_t bus_us = dev.i2c_stats.BusTimeUs - mark.BusTimeUs;
+    uint32_t us = VL53L0X_GetTickCountUs() - mark_us;
+
+    printf("%-48s %4u.%02u %9u %9u\n", name,
+        tx / samples, tx * 100 / samples % 100, bus_us / samples,
+        us / samples);
+}
+
+/* one sample per call of the standard API in continuous ranging */
+static void continuous_standard(void)
+{
+    VL53L0X_RangingMeasurementData_t data;
+    uint8_t ready;
+
+    for (int i = 0; i < SAMPLES; ) {
+        TEST_CALL(VL53L0X_GetMeasurementDataReady(&dev, &ready));
+        if (!ready) {
+            VL53L0X_WaitDataReady(&dev);
+            continue;
+        }
+        TEST_CALL(VL53L0X_GetRangingMeasurementData(&dev, &data));
+        TEST_CALL(VL53L0X_ClearInterruptMask(&dev, 0));
+        i++;
+    }
+}
+
+/* the fast readout, StartNext restarts single ranging in the same write */
+static void fast_readout(uint8_t StartNext)
+{
+    VL53L0X_RangingMeasurementData_t data;
+    uint8_t ready;
+
+    for (int i = 0; i < SAMPLES; ) {
+        TEST_CALL(VL53L0X_GetRangingMeasurementDataFast(&dev, &data,
+            StartNext, &ready));
+        if (ready)
+            i++;
+        else
+            VL53L0X_WaitDataReady(&dev);
+    }
+}
+
+static void ranging(const char *readout)
+{
+    VL53L0X_RangingMeasurementData_t data;
+    char name[64];
+    uint8_t ready;
+
+    snprintf(name, sizeof(name), "PerformSingleRanging, %s", readout);
+    start();
+    for (int i = 0; i < SAMPLES; i++)
+        TEST_CALL(VL53L0X_PerformSingleRangingMeasurement(&dev, &data));
+    report(name, SAMPLES);
+
+    snprintf(name, sizeof(name), "PerformFastSingleRanging, %s", readout);
+    start();
+    for (int i = 0; i < SAMPLES; i++)
+        TEST_CALL(VL53L0X_PerformFastSingleRangingMeasurement(&dev, &data));
+    report(name, SAMPLES);
+
+    snprintf(name, sizeof(name), "single, StartNext, %s", readout);
+    TEST_CALL(VL53L0X_StartMeasurement(&dev));
+    start();
+    fast_readout(1);
+    report(name, SAMPLES);
+    VL53L0X_WaitDataReady(&dev);
+    TEST_CALL(VL53L0X_GetRangingMeasurementDataFast(&dev, &data, 0, &ready));
+
+    TEST_CALL(VL53L0X_SetDeviceMode(&dev,
+        VL53L0X_DEVICEMODE_CONTINUOUS_RANGING));
+    TEST_CALL(VL53L0X_StartMeasurement(&dev));
+    snprintf(name, sizeof(name), "continuous standard, %s", readout);
+    start();
+    continuous_standard();
+    report(name, SAMPLES);
+    snprintf(name, sizeof(name), "continuous fast, %s", readout);
+    start();
+    fast_readout(0);
+    report(name, SAMPLES);
+    TEST_CALL(VL53L0X_StopMeasurement(&dev));
+    TEST_CALL(VL53L0X_ClearInterruptMask(&dev, 0));
+    TEST_CALL(VL53L0X_SetDeviceMode(&dev, VL53L0X_DEVICEMODE_SINGLE_RANGING));
+}
+
+int main(void)
+{
+    uint32_t refSpadCount;
+    uint8_t isApertureSpads;
+
+    printf("%-48s %7s %9s %9s\n", "per call or sample", "bus tx", "bus us",
+        "total us");
+
+    test_attach(&dev, &sensor);
+    start();
+    TEST_CALL(VL53L0X_DataInit(&dev));
+    report("DataInit", 1);
+    start();
+    TEST_CALL(VL53L0X_StaticInit(&dev));
+    report("StaticInit", 1);
+    test_attach(&dev, &sensor);
+    start();
+    test_bring_up(&dev);
+    report("bring-up (init and calibration)", 1);
+
+    /* SPADs from the NVM pass the check, the search runs in full */
+    start();
+    TEST_CALL(VL53L0X_PerformRefSpadManagement(&dev, &refSpadCount,
+        &isApertureSpads));
+    report("PerformRefSpadManagement", 1);
+    TEST_CALL(VL53L0X_SetReferenceSpads(&dev, 5, 1));
+    start();
+    TEST_CALL(VL53L0X_PerformFastRefSpadManagement(&dev, &refSpadCount,
+        &isApertureSpads));
+    report("PerformFastRefSpadManagement", 1);
+    TEST_CALL(VL53L0X_SetDeviceMode(&dev, VL53L0X_DEVICEMODE_SINGLE_RANGING));
+
+    VL53L0X_SetShadowEnable(&dev, 1);
+    ranging("polled");
+    TEST_CALL(VL53L0X_SetInterruptPin(&dev, 2, VL53L0X_INTERRUPTPOLARITY_LOW));
+    ranging("GPIO1");
+    TEST_CALL(VL53L0X_SetLimitCheckEnable(&dev,
+        VL53L0X_CHECKENABLE_SIGNAL_REF_CLIP, 1));
+    ranging("GPIO1, ref clip check");
+    TEST_ASSERT_EQUAL(0, dev.gpio1.Timeouts);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Single ranging end to end: DataInit, StaticInit and calibration against
+ * a fresh simulated sensor, then each ranging path has to return the
+ * scripted results in order, also after an interrupt clear that did not
+ * take.
+ */
+#include "vl53l0x_test.h"
+
+static const VL53L0X_SimRange_t script[] = {
+    /* range, device status (11 valid, 4 signal fail), signal, ambient, SPADs */
+    { 123, 11, 10 << 7, 1 << 5, 8 << 8 },
+    { 456, 11, 5 << 7, 1 << 5, 8 << 8 },
+    { 789, 4, 1 << 5, 1 << 5, 8 << 8 },
+};
+
+#define SCRIPT_LENGTH (sizeof(script) / sizeof(script[0]))
+
+typedef VL53L0X_Error (*measure_t)(VL53L0X_DEV Dev,
+    VL53L0X_RangingMeasurementData_t *pData);
+
+static void check_script(VL53L0X_Dev_t *pDev, VL53L0X_SimDevice_t *pSim,
+    measure_t measure, const char *name)
+{
+    VL53L0X_RangingMeasurementData_t data;
+
+    pSim->pScript = script;
+    pSim->ScriptLength = SCRIPT_LENGTH;
+    pSim->Measurements = 0;
+    for (uint32_t i = 0; i < 2 * SCRIPT_LENGTH; i++) {
+        const VL53L0X_SimRange_t *expected = &script[i % SCRIPT_LENGTH];
+
+        TEST_CALL(measure(pDev, &data));
+        if (expected->DeviceRangeStatus == 11) {
+            TEST_ASSERT_EQUAL(expected->RangeMilliMeter, data.RangeMilliMeter);
+            TEST_ASSERT_EQUAL(0, data.RangeStatus);
+        } else {
+            TEST_ASSERT(data.RangeStatus != 0);
+        }
+    }
+    TEST_ASSERT_EQUAL(2 * SCRIPT_LENGTH, pSim->Measurements);
+    printf("%-40s ok\n", name);
+}
+
+/* VL53L0X_GetRangingMeasurementDataFast() in continuous mode, as the
+ * ranging service calls it */
+static VL53L0X_Error read_continuous(VL53L0X_DEV Dev,
+    VL53L0X_RangingMeasurementData_t *pData)
+{
+    VL53L0X_Error status;
+    uint8_t ready = 0;
+
+    do {
+        VL53L0X_WaitDataReady(Dev);
+        status = VL53L0X_GetRangingMeasurementDataFast(Dev, pData, 0, &ready);
+    } while (status == VL53L0X_ERROR_NONE && !ready);
+    return status;
+}
+
+/* the fast readout's interrupt clear is lost once: the next read must not
+ * return the same sample again, and must leave the interrupt cleared */
+static void check_lost_clear(VL53L0X_Dev_t *pDev, VL53L0X_SimDevice_t *pSim,
+    measure_t measure, const char *name)
+{
+    VL53L0X_RangingMeasurementData_t data;
+    uint32_t pending;
+
+    pSim->pScript = script;
+    pSim->ScriptLength = SCRIPT_LENGTH;
+    pSim->Measurements = 0;
+    pSim->DropClears = 1;
+    TEST_CALL(measure(pDev, &data));
+    TEST_ASSERT_EQUAL(script[0].RangeMilliMeter, data.RangeMilliMeter);
+    TEST_ASSERT_EQUAL(0, pSim->DropClears);
+    TEST_CALL(VL53L0X_GetInterruptMaskStatus(pDev, &pending));
+    TEST_ASSERT(pending != 0);
+
+    TEST_CALL(measure(pDev, &data));
+    TEST_ASSERT_EQUAL(script[1].RangeMilliMeter, data.RangeMilliMeter);
+    TEST_ASSERT_EQUAL(2, pSim->Measurements);
+    printf("%-40s ok\n", name);
+}
+
+static void check_lost_clears(VL53L0X_Dev_t *pDev, VL53L0X_SimDevice_t *pSim,
+    const char *name)
+{
+    char what[64];
+
+    snprintf(what, sizeof(what), "lost clear, single%s", name);
+    check_lost_clear(pDev, pSim, VL53L0X_PerformFastSingleRangingMeasurement,
+        what);
+
+    TEST_CALL(VL53L0X_SetDeviceMode(pDev,
+        VL53L0X_DEVICEMODE_CONTINUOUS_RANGING));
+    TEST_CALL(VL53L0X_StartMeasurement(pDev));
+    snprintf(what, sizeof(what), "lost clear, continuous%s", name);
+    check_lost_clear(pDev, pSim, read_continuous, what);
+    TEST_CALL(VL53L0X_StopMeasurement(pDev));
+    TEST_CALL(VL53L0X_ClearInterruptMask(pDev, 0));
+    TEST_CALL(VL53L0X_SetDeviceMode(pDev, VL53L0X_DEVICEMODE_SINGLE_RANGING));
+}
+
+int main(void)
+{
+    static VL53L0X_SimDevice_t sensor;
+    VL53L0X_Dev_t dev;
+    VL53L0X_RangingMeasurementData_t data;
+
+    test_attach(&dev, &sensor);
+    test_bring_up(&dev);
+
+    /* the default target before any script */
+    TEST_CALL(VL53L0X_PerformSingleRangingMeasurement(&dev, &data));
+    TEST_ASSERT_EQUAL(500, data.RangeMilliMeter);
+    TEST_ASSERT_EQUAL(0, data.RangeStatus);
+
+    check_script(&dev, &sensor, VL53L0X_PerformSingleRangingMeasurement,
+        "PerformSingleRangingMeasurement");
+    check_script(&dev, &sensor, VL53L0X_PerformFastSingleRangingMeasurement,
+        "PerformFastSingleRangingMeasurement");
+    check_lost_clears(&dev, &sensor, "");
+
+    /* the same with data ready signalled on GPIO1 */
+    TEST_CALL(VL53L0X_SetInterruptPin(&dev, 2, VL53L0X_INTERRUPTPOLARITY_LOW));
+    check_script(&dev, &sensor, VL53L0X_PerformSingleRangingMeasurement,
+        "PerformSingleRangingMeasurement, GPIO1");
+    check_script(&dev, &sensor, VL53L0X_PerformFastSingleRangingMeasurement,
+        "PerformFastSingleRangingMeasurement, GPIO1");
+    check_lost_clears(&dev, &sensor, ", GPIO1");
+    TEST_ASSERT_EQUAL(0, dev.gpio1.Timeouts);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * The reworked sigma/Dmax kernels of vl53l0x_api_core.c against the ST
+ * originals in vl53l0x_sigma_ref.c: VL53L0X_calc_sigma_estimate() over
+ * random samples in blocks that share a timing, so the first call of a block
+ * recomputes the cached timing terms and the rest reuse them.
+ */
+#include "vl53l0x_test.h"
+#include "vl53l0x_api_core.h"
+#include "vl53l0x_sigma_ref.h"
+
+#define TIMINGS 2000
+#define SAMPLES_PER_TIMING 64
+
+static VL53L0X_SimDevice_t sensor;
+static VL53L0X_Dev_t dev;
+static VL53L0X_DEV const Dev = &dev;
+static uint32_t seed = 0x2545f491;
+
+/* xorshift32, fixed seed so a failure reproduces */
+static uint32_t random32(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+/* mostly in the range the sensor reports, sometimes any 32 bit value */
+static uint32_t random_rate(uint32_t max)
+{
+    switch (random32() % 8) {
+    case 0:
+        return 0;
+    case 1:
+        return random32();
+    default:
+        return random32() % max;
+    }
+}
+
+static void set_random_timing(void)
+{
+    static const uint8_t final_periods[] = { 8, 10, 12, 14 };
+    static const uint8_t pre_periods[] = { 12, 14, 16, 18 };
+
+    VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, FinalRangeTimeoutMicroSecs,
+        1000 + random32() % 300000);
+    VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, FinalRangeVcselPulsePeriod,
+        final_periods[random32() % 4]);
+    VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, PreRangeTimeoutMicroSecs,
+        random32() % 50000);
+    VL53L0X_SETDEVICESPECIFICPARAMETER(Dev, PreRangeVcselPulsePeriod,
+        pre_periods[random32() % 4]);
+
+    VL53L0X_SETPARAMETERFIELD(Dev, XTalkCompensationEnable,
+        random32() % 2);
+    /* past 50 kcps total the estimate saturates */
+    VL53L0X_SETPARAMETERFIELD(Dev, XTalkCompensationRateMegaCps,
+        random_rate(0x40));
+    PALDevDataSet(Dev, DmaxCalRangeMilliMeter, 100 + random32() % 800);
+    PALDevDataSet(Dev, DmaxCalSignalRateRtnMegaCps,
+        1 + random32() % (64 << 16));
+}
+
+static void random_sample(VL53L0X_RangingMeasurementData_t *pData)
+{
+    memset(pData, 0, sizeof(*pData));
+    pData->RangeMilliMeter = random32() % 8192;
+    pData->RangeStatus = random32() % 2 ? 0 : random32() % 6;
+    /* 9.7 rates and 8.8 SPAD counts as read from the sensor */
+    pData->SignalRateRtnMegaCps = random_rate(512 << 16);
+    pData->AmbientRateRtnMegaCps = random_rate(512 << 16);
+    pData->EffectiveSpadRtnCount = random_rate(256 << 8) & 0xffff;
+}
+
+static void check_sigma(const VL53L0X_RangingMeasurementData_t *pSample)
+{
+    VL53L0X_RangingMeasurementData_t data = *pSample, refData = *pSample;
+    FixPoint1616_t sigma, refSigma, devSigma, refDevSigma;
+    uint32_t dmax, refDmax;
+    VL53L0X_Error status, refStatus;
+
+    refStatus = ref_calc_sigma_estimate(Dev, &refData, &refSigma, &refDmax);
+    refDevSigma = PALDevDataGet(Dev, SigmaEstimate);
+    PALDevDataSet(Dev, SigmaEstimate, 0);
+    status = VL53L0X_calc_sigma_estimate(Dev, &data, &sigma, &dmax);
+    devSigma = PALDevDataGet(Dev, SigmaEstimate);
+
+    if (status != refStatus || sigma != refSigma || dmax != refDmax ||
+            devSigma != refDevSigma)
+        TEST_FAIL("range %u status %u signal 0x%x ambient 0x%x spads 0x%x: "
+            "status %d sigma 0x%x dmax %u, expected %d 0x%x %u",
+            pSample->RangeMilliMeter, pSample->RangeStatus,
+            pSample->SignalRateRtnMegaCps, pSample->AmbientRateRtnMegaCps,
+            pSample->EffectiveSpadRtnCount, status, sigma, dmax,
+            refStatus, refSigma, refDmax);
+}
+
+static void test_sigma_estimate(void)
+{
+    VL53L0X_RangingMeasurementData_t sample;
+
+    test_attach(&dev, &sensor);
+    test_bring_up(Dev);
+
+    /* the timing the bring-up left, then random ones */
+    for (uint32_t t = 0; t < TIMINGS; t++) {
+        if (t > 0)
+            set_random_timing();
+        for (uint32_t i = 0; i < SAMPLES_PER_TIMING; i++) {
+            random_sample(&sample);
+            check_sigma(&sample);
+            /* the first call of a block filled the timing cache */
+            TEST_ASSERT_EQUAL(
+                VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+                    FinalRangeTimeoutMicroSecs),
+                VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+                    SigmaTimingFinalRangeTimeoutMicroSecs));
+        }
+    }
+}
+
+int main(void)
+{
+    test_sigma_estimate();
+    printf("sigma/Dmax kernels match ST API 1.0.2\n");
+    return 0;
+}
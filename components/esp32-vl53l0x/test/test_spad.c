@@ -0,0 +1,121 @@
+/*
+ * VL53L0X_PerformFastRefSpadManagement() against the full search of
+ * VL53L0X_PerformRefSpadManagement(): a reference SPAD map that is already
+ * applied and close enough to the target rate is kept after one
+ * measurement, any other map falls back to the search and ends where the
+ * search ends.
+ */
+#include "vl53l0x_test.h"
+
+static VL53L0X_SimDevice_t sensor;
+static VL53L0X_Dev_t dev;
+static VL53L0X_DEV const Dev = &dev;
+
+typedef struct {
+    uint32_t count;
+    uint8_t aperture;
+    uint32_t transactions;
+} spad_result_t;
+
+/* DataInit and StaticInit, which apply the map from the sensor NVM */
+static void init(uint16_t ref_spad_rate)
+{
+    test_attach(&dev, &sensor);
+    sensor.RefSpadSignalRate = ref_spad_rate;
+    TEST_CALL(VL53L0X_DataInit(&dev));
+    TEST_CALL(VL53L0X_StaticInit(&dev));
+}
+
+static spad_result_t full_search(uint16_t ref_spad_rate)
+{
+    spad_result_t result;
+    uint32_t start;
+
+    init(ref_spad_rate);
+    start = sensor.Transactions;
+    TEST_CALL(VL53L0X_PerformRefSpadManagement(&dev, &result.count,
+        &result.aperture));
+    result.transactions = sensor.Transactions - start;
+    return result;
+}
+
+/* Count 0 starts from the NVM map, others apply that map first */
+static spad_result_t fast_search(uint16_t ref_spad_rate, uint32_t count,
+    uint8_t aperture)
+{
+    spad_result_t result;
+    uint32_t start;
+
+    init(ref_spad_rate);
+    if (count > 0)
+        TEST_CALL(VL53L0X_SetReferenceSpads(&dev, count, aperture));
+    start = sensor.Transactions;
+    TEST_CALL(VL53L0X_PerformFastRefSpadManagement(&dev, &result.count,
+        &result.aperture));
+    result.transactions = sensor.Transactions - start;
+    return result;
+}
+
+/* the reference rate of the applied map, as the sensor measures it */
+static uint32_t ref_rate(const spad_result_t *pResult)
+{
+    return pResult->count * sensor.RefSpadSignalRate;
+}
+
+static void test_keep(void)
+{
+    /* 3.5 MCPS per SPAD, the 5 aperture SPADs of the NVM give 17.5 */
+    spad_result_t full = full_search(0x01C0);
+    spad_result_t fast = fast_search(0x01C0, 0, 0);
+    uint16_t target = PALDevDataGet(Dev, targetRefRate);
+
+    TEST_ASSERT_EQUAL(5, fast.count);
+    TEST_ASSERT_EQUAL(1, fast.aperture);
+    TEST_ASSERT(abs((int32_t)ref_rate(&fast) - target) <= target / 4);
+    TEST_ASSERT_EQUAL(1, VL53L0X_GETDEVICESPECIFICPARAMETER(Dev,
+        RefSpadsInitialised));
+    /* one reference measurement instead of one per SPAD added */
+    if (fast.transactions * 2 > full.transactions)
+        TEST_FAIL("kept map took %u transactions, the full search %u",
+            fast.transactions, full.transactions);
+    printf("%-40s ok\n", "fast SPADs, NVM map kept");
+
+    /* 10 MCPS per SPAD: the fewest aperture SPADs are still too strong,
+     * the search stops there too */
+    full = full_search(0x0500);
+    fast = fast_search(0x0500, 3, 1);
+    TEST_ASSERT(ref_rate(&fast) > target + target / 4);
+    TEST_ASSERT_EQUAL(full.count, fast.count);
+    TEST_ASSERT_EQUAL(full.aperture, fast.aperture);
+    TEST_ASSERT(fast.transactions < full.transactions);
+    printf("%-40s ok\n", "fast SPADs, minimal map kept");
+}
+
+static void test_fall_back(void)
+{
+    static const uint32_t counts[] = { 3, 8, 12 };
+    spad_result_t full = full_search(0x01C0);
+    spad_result_t kept = fast_search(0x01C0, 0, 0);
+    spad_result_t fast;
+    char name[40];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        fast = fast_search(0x01C0, counts[i], 1);
+        TEST_ASSERT_EQUAL(full.count, fast.count);
+        TEST_ASSERT_EQUAL(full.aperture, fast.aperture);
+        /* the check, then the whole search */
+        TEST_ASSERT(fast.transactions > full.transactions);
+        TEST_ASSERT_EQUAL(full.transactions + kept.transactions,
+            fast.transactions);
+        snprintf(name, sizeof(name), "fast SPADs, %u falls back", counts[i]);
+        printf("%-40s ok\n", name);
+    }
+}
+
+int main(void)
+{
+    test_keep();
+    test_fall_back();
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * The statistics of vl53l0x_stats.c: P-square quantile estimates against
+ * the exact quantiles of the samples fed, the nearest rank answers while
+ * fewer than five samples came in, and the log2 latency histogram.
+ */
+#include "vl53l0x_test.h"
+
+#define SAMPLES 20000
+/* estimates must fall between the exact p - 2% and p + 2% quantiles */
+#define RANK_TOLERANCE 0.02f
+
+static const uint8_t percent[VL53L0X_STATS_QUANTILES] =
+    VL53L0X_STATS_QUANTILE_PERCENT;
+static uint32_t seed = 0x9e3779b9;
+static float samples[SAMPLES];
+static float sorted[SAMPLES];
+
+/* xorshift32, fixed seed so a failure reproduces */
+static uint32_t random32(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static float uniform(void)
+{
+    return (random32() >> 8) / 16777216.0f;
+}
+
+static int compare_float(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/* exact quantile, nearest rank */
+static float exact_quantile(float p)
+{
+    uint32_t rank = (uint32_t)(p * SAMPLES + 0.5f);
+
+    if (rank > SAMPLES - 1)
+        rank = SAMPLES - 1;
+    return sorted[rank];
+}
+
+static void add_sample(VL53L0X_Stats_t *pStats, uint8_t status,
+    uint16_t range_mm, float signal_mcps)
+{
+    VL53L0X_RangingMeasurementData_t data;
+
+    memset(&data, 0, sizeof(data));
+    data.RangeStatus = status;
+    data.RangeMilliMeter = range_mm;
+    data.SignalRateRtnMegaCps = (FixPoint1616_t)(signal_mcps * 65536.0f);
+    VL53L0X_StatsAddSample(pStats, &data, 0, 1000);
+}
+
+/*
+ * Feeds samples[] as signal rates, and as ranges with a range status of 0,
+ * then checks every quantile estimate against the sorted samples.
+ */
+static void check_quantiles(const char *name, int as_range)
+{
+    VL53L0X_Stats_t stats;
+    const VL53L0X_Quantile_t *q;
+    float p, estimate, low, high;
+    int i;
+
+    VL53L0X_StatsClear(&stats);
+    for (i = 0; i < SAMPLES; i++) {
+        if (as_range)
+            add_sample(&stats, 0, (uint16_t)samples[i], 1);
+        else
+            add_sample(&stats, 4, 0, samples[i]);
+    }
+    TEST_ASSERT_EQUAL(SAMPLES, stats.Samples);
+
+    memcpy(sorted, samples, sizeof(sorted));
+    if (as_range)
+        for (i = 0; i < SAMPLES; i++)
+            sorted[i] = (uint16_t)sorted[i];
+    qsort(sorted, SAMPLES, sizeof(sorted[0]), compare_float);
+
+    for (i = 0; i < VL53L0X_STATS_QUANTILES; i++) {
+        p = percent[i] / 100.0f;
+        q = as_range ? &stats.Range[i] : &stats.Signal[i];
+        TEST_ASSERT_EQUAL(SAMPLES, q->Count);
+        estimate = VL53L0X_StatsQuantile(q);
+        low = exact_quantile(p - RANK_TOLERANCE);
+        high = exact_quantile(p + RANK_TOLERANCE);
+        if (estimate < low || estimate > high)
+            TEST_FAIL("%s p%u is %f, exact %f, expected %f to %f", name,
+                percent[i], estimate, exact_quantile(p), low, high);
+    }
+    /* ranges only count with status 0, signal rates always */
+    if (as_range)
+        TEST_ASSERT_EQUAL(SAMPLES, stats.Signal[0].Count);
+    else
+        TEST_ASSERT_EQUAL(0, stats.Range[0].Count);
+    printf("%-40s ok\n", name);
+}
+
+static void test_quantiles(void)
+{
+    int i, k;
+    float x;
+
+    for (i = 0; i < SAMPLES; i++)
+        samples[i] = uniform() * 2000;
+    check_quantiles("quantiles, uniform range", 1);
+
+    /* Irwin-Hall, close to a normal of mean 1000 mm and sigma 20 mm */
+    for (i = 0; i < SAMPLES; i++) {
+        for (x = 0, k = 0; k < 12; k++)
+            x += uniform();
+        samples[i] = 880 + x * 20;
+    }
+    check_quantiles("quantiles, normal range", 1);
+
+    /* skewed towards low rates, as signal rates are */
+    for (i = 0; i < SAMPLES; i++) {
+        x = uniform();
+        samples[i] = x * x * x * 40;
+    }
+    check_quantiles("quantiles, skewed signal", 0);
+}
+
+/* before five samples the estimate is a nearest rank of the samples seen */
+static void test_quantiles_warm_up(void)
+{
+    static const uint16_t ranges[] = { 400, 100, 300, 200 };
+    /* after 1, 2, 3 and 4 samples, for p10, p50 and p90 */
+    static const uint16_t expected[4][VL53L0X_STATS_QUANTILES] = {
+        { 400, 400, 400 },
+        { 100, 400, 400 },
+        { 100, 300, 400 },
+        { 100, 300, 400 },
+    };
+    VL53L0X_Stats_t stats;
+    int n, i;
+
+    VL53L0X_StatsClear(&stats);
+    for (i = 0; i < VL53L0X_STATS_QUANTILES; i++)
+        TEST_ASSERT_EQUAL(0, VL53L0X_StatsQuantile(&stats.Range[i]));
+
+    for (n = 0; n < 4; n++) {
+        add_sample(&stats, 0, ranges[n], 1);
+        /* invalid ranges do not count */
+        add_sample(&stats, 2, 8190, 1);
+        for (i = 0; i < VL53L0X_STATS_QUANTILES; i++) {
+            TEST_ASSERT_EQUAL(n + 1, stats.Range[i].Count);
+            TEST_ASSERT_EQUAL(expected[n][i],
+                VL53L0X_StatsQuantile(&stats.Range[i]));
+        }
+    }
+
+    /* the fifth sample turns the sorted samples into the markers */
+    add_sample(&stats, 0, 500, 1);
+    TEST_ASSERT_EQUAL(300, VL53L0X_StatsQuantile(&stats.Range[1]));
+    printf("%-40s ok\n", "quantiles, warm-up");
+}
+
+static void test_histogram(void)
+{
+    uint32_t bins[12];
+    int i;
+
+    memset(bins, 0, sizeof(bins));
+    TEST_ASSERT_EQUAL(0, VL53L0X_HistogramPercentile(bins, 12, 7, 0, 50));
+
+    /* 90 fast, 9 slower, one far past the last bin */
+    for (i = 0; i < 90; i++)
+        VL53L0X_HistogramAdd(bins, 12, 7, 100);
+    for (i = 0; i < 9; i++)
+        VL53L0X_HistogramAdd(bins, 12, 7, 1000);
+    VL53L0X_HistogramAdd(bins, 12, 7, 10000000);
+    TEST_ASSERT_EQUAL(90, bins[0]);
+    TEST_ASSERT_EQUAL(9, bins[3]);
+    TEST_ASSERT_EQUAL(1, bins[11]);
+
+    TEST_ASSERT_EQUAL(128,
+        VL53L0X_HistogramPercentile(bins, 12, 7, 10000000, 1));
+    TEST_ASSERT_EQUAL(128,
+        VL53L0X_HistogramPercentile(bins, 12, 7, 10000000, 90));
+    TEST_ASSERT_EQUAL(1024,
+        VL53L0X_HistogramPercentile(bins, 12, 7, 10000000, 91));
+    TEST_ASSERT_EQUAL(1024,
+        VL53L0X_HistogramPercentile(bins, 12, 7, 10000000, 99));
+    /* the last bin has no upper bound, the maximum is */
+    TEST_ASSERT_EQUAL(10000000,
+        VL53L0X_HistogramPercentile(bins, 12, 7, 10000000, 100));
+    /* and no bound is past the maximum */
+    TEST_ASSERT_EQUAL(1000,
+        VL53L0X_HistogramPercentile(bins, 12, 7, 1000, 99));
+
+    /* bin edges: bin i holds latencies below 2^(i + 7) */
+    memset(bins, 0, sizeof(bins));
+    VL53L0X_HistogramAdd(bins, 12, 7, 127);
+    VL53L0X_HistogramAdd(bins, 12, 7, 128);
+    VL53L0X_HistogramAdd(bins, 12, 7, 255);
+    VL53L0X_HistogramAdd(bins, 12, 7, 256);
+    TEST_ASSERT_EQUAL(1, bins[0]);
+    TEST_ASSERT_EQUAL(2, bins[1]);
+    TEST_ASSERT_EQUAL(1, bins[2]);
+    printf("%-40s ok\n", "latency histogram");
+}
+
+int main(void)
+{
+    test_quantiles();
+    test_quantiles_warm_up();
+    test_histogram();
+    return 0;
+}
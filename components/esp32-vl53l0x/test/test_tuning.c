@@ -0,0 +1,44 @@
+/*
+ * StaticInit with the compiled tuning blob has to leave the sensor exactly
+ * as with the table it was compiled from: one StaticInit loads
+ * DefaultTuningSettings of vl53l0x_tuning.h through
+ * VL53L0X_SetTuningSettingBuffer(), another the internal blob, and every
+ * register page of the two simulated sensors must match. The Makefile
+ * also regenerates the blob and compares it with the committed header.
+ */
+#include "vl53l0x_test.h"
+#include "vl53l0x_tuning.h"
+
+static VL53L0X_SimDevice_t table_sensor, blob_sensor;
+static VL53L0X_Dev_t dev;
+
+int main(void)
+{
+    uint32_t table_tx, blob_tx;
+
+    test_attach(&dev, &table_sensor);
+    TEST_CALL(VL53L0X_DataInit(&dev));
+    TEST_CALL(VL53L0X_SetTuningSettingBuffer(&dev, DefaultTuningSettings, 0));
+    TEST_CALL(VL53L0X_StaticInit(&dev));
+    table_tx = dev.i2c_stats.Transactions;
+
+    test_attach(&dev, &blob_sensor);
+    TEST_CALL(VL53L0X_DataInit(&dev));
+    TEST_CALL(VL53L0X_StaticInit(&dev));
+    blob_tx = dev.i2c_stats.Transactions;
+
+    if (memcmp(table_sensor.Regs, blob_sensor.Regs,
+            sizeof(table_sensor.Regs)) != 0)
+        for (uint32_t page = 0; page < VL53L0X_SIM_PAGES; page++)
+            for (uint32_t reg = 0; reg < 256; reg++)
+                if (table_sensor.Regs[page][reg] != blob_sensor.Regs[page][reg])
+                    TEST_FAIL("page %u register 0x%02x is 0x%02x, "
+                        "expected 0x%02x", page, reg,
+                        blob_sensor.Regs[page][reg],
+                        table_sensor.Regs[page][reg]);
+    TEST_ASSERT_EQUAL(table_sensor.Page, blob_sensor.Page);
+
+    printf("StaticInit registers match, %u transactions with the table, "
+        "%u with the blob\n", table_tx, blob_tx);
+    return 0;
+}
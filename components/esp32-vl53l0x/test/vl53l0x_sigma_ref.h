@@ -0,0 +1,25 @@
+#ifndef _VL53L0X_SIGMA_REF_H_
+#define _VL53L0X_SIGMA_REF_H_
+
+#include "vl53l0x_def.h"
+#include "vl53l0x_platform.h"
+
+/**
+ * @file vl53l0x_sigma_ref.h
+ *
+ * @brief ST API 1.0.2 sigma and Dmax kernels, the reference for the
+ * reworked ones in vl53l0x_api_core.c
+ */
+
+/** VL53L0X_isqrt() as shipped by ST */
+uint32_t ref_isqrt(uint32_t num);
+
+/**
+ * VL53L0X_calc_sigma_estimate() as shipped by ST, recomputing the timing
+ * terms on every call. Updates the device SigmaEstimate like the original.
+ */
+VL53L0X_Error ref_calc_sigma_estimate(VL53L0X_DEV Dev,
+    VL53L0X_RangingMeasurementData_t *pRangingMeasurementData,
+    FixPoint1616_t *pSigmaEstimate, uint32_t *pDmax_mm);
+
+#endif /* _VL53L0X_SIGMA_REF_H_ */
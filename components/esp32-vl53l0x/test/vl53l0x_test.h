@@ -0,0 +1,85 @@
+#ifndef _VL53L0X_TEST_H_
+#define _VL53L0X_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vl53l0x_api.h"
+#include "vl53l0x_platform.h"
+
+/**
+ * @file vl53l0x_test.h
+ *
+ * @brief Checks and sensor bring-up shared by the host tests
+ *
+ * The tests build with VL53L0X_PLATFORM_SIM against the register model in
+ * vl53l0x_i2c_sim.c, see the Makefile next to this file. A failed check
+ * prints where it failed and exits the test with status 1.
+ */
+
+#define TEST_FAIL(...) do { \
+        printf("%s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        exit(1); \
+    } while (0)
+
+#define TEST_ASSERT(cond) do { \
+        if (!(cond)) \
+            TEST_FAIL("%s", #cond); \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do { \
+        long long _e = (long long)(expected), _a = (long long)(actual); \
+        if (_e != _a) \
+            TEST_FAIL("%s is %lld, expected %lld", #actual, _a, _e); \
+    } while (0)
+
+/* an ST API call that must return VL53L0X_ERROR_NONE */
+#define TEST_CALL(call) do { \
+        VL53L0X_Error _status = (call); \
+        if (_status != VL53L0X_ERROR_NONE) \
+            TEST_FAIL("%s returned %d", #call, _status); \
+    } while (0)
+
+/**
+ * @brief Power on a simulated sensor on port 0 and bind a device to it
+ *
+ * Detaches every sensor and rewinds the simulated clock first, so each
+ * call starts from the same state.
+ *
+ * @param   pDev      Device, reset to address 0x29 on port 0
+ * @param   pSim      Sensor state
+ */
+static inline void test_attach(VL53L0X_Dev_t *pDev, VL53L0X_SimDevice_t *pSim)
+{
+    VL53L0X_SimDetachAll();
+    VL53L0X_SimReset(pSim);
+    VL53L0X_SimAttach(0, pSim);
+    memset(pDev, 0, sizeof(*pDev));
+    pDev->i2c_address = 0x29;
+    pDev->i2c_port_num = 0;
+}
+
+/**
+ * @brief The apps' bring-up: DataInit, StaticInit, calibration, single
+ * ranging with a 33 ms budget
+ *
+ * @param   pDev      Device bound by test_attach()
+ */
+static inline void test_bring_up(VL53L0X_Dev_t *pDev)
+{
+    uint32_t refSpadCount;
+    uint8_t isApertureSpads, VhvSettings, PhaseCal;
+
+    TEST_CALL(VL53L0X_DataInit(pDev));
+    TEST_CALL(VL53L0X_StaticInit(pDev));
+    TEST_CALL(VL53L0X_PerformRefSpadManagement(pDev, &refSpadCount,
+        &isApertureSpads));
+    TEST_CALL(VL53L0X_PerformRefCalibration(pDev, &VhvSettings, &PhaseCal));
+    TEST_CALL(VL53L0X_SetDeviceMode(pDev, VL53L0X_DEVICEMODE_SINGLE_RANGING));
+    TEST_CALL(VL53L0X_SetMeasurementTimingBudgetMicroSeconds(pDev, 33000));
+}
+
+#endif  /* _VL53L0X_TEST_H_ */
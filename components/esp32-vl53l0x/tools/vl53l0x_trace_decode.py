@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Decode the binary VL53L0X API trace printed by VL53L0X_trace_dump().
+
+Usage: vl53l0x_trace_decode.py build/<project>.elf [serial.log]
+
+Reads the console log (stdin if no file is given), picks the hex records
+between VL53L0X-TRACE-BEGIN and VL53L0X-TRACE-END, resolves the function
+name pointers against the firmware ELF and prints one call tree per task
+with the time spent in every call. A summary of calls and total/self time
+per function follows.
+"""
+
+import struct
+import sys
+from collections import defaultdict
+
+# VL53L0X_TraceRecord_t on the ESP32 (little endian, 32 bit pointers)
+RECORD = struct.Struct('<IIIhBB')
+TRACE_START = 0
+TRACE_END = 1
+MODULES = {1: 'API', 2: 'PLATFORM'}
+
+
+class Elf:
+    """Just enough of ELF32 to read strings from allocated sections"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[4] != 1:
+            raise ValueError('%s: not an ELF32 file' % path)
+        shoff, = struct.unpack_from('<I', self.data, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', self.data, 0x2e)
+        self.sections = []
+        for i in range(shnum):
+            (_, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                '<IIIIII', self.data, shoff + i * shentsize)
+            # SHT_PROGBITS and SHF_ALLOC: loaded into the target's memory
+            if sh_type == 1 and flags & 2 and addr:
+                self.sections.append((addr, offset, size))
+
+    def string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b'\0', start)
+                return self.data[start:end].decode('ascii', 'replace')
+        return '0x%08x' % address
+
+
+def read_dumps(lines):
+    """Yield the records of every dump found in the log"""
+    records = None
+    for line in lines:
+        line = line.strip()
+        if 'VL53L0X-TRACE-BEGIN' in line:
+            fields = line.split()
+            size = int(fields[-1])
+            if size != RECORD.size:
+                raise ValueError('record size %d, decoder expects %d' % (size, RECORD.size))
+            if int(fields[-2]):
+                print('# %s records lost to ring wrap-around' % fields[-2])
+            records = []
+        elif 'VL53L0X-TRACE-END' in line and records is not None:
+            yield records
+            records = None
+        elif records is not None and line:
+            records.append(RECORD.unpack(bytes.fromhex(line)))
+
+
+def decode(records, elf, totals):
+    stacks = defaultdict(list)
+    for function, task, time_us, status, event, module in records:
+        name = elf.string(function)
+        stack = stacks[task]
+        if event == TRACE_START:
+            print('%10u %08x %s> %s' % (time_us, task, '  ' * len(stack), name))
+            stack.append([name, time_us, 0])
+            continue
+
+        # an END without its START was cut off by the ring, skip it
+        if not stack or stack[-1][0] != name:
+            continue
+        _, start_us, child_us = stack.pop()
+        elapsed = (time_us - start_us) & 0xffffffff
+        if stack:
+            stack[-1][2] += elapsed
+        entry = totals[name]
+        entry[0] += 1
+        entry[1] += elapsed
+        entry[2] += elapsed - child_us
+        print('%10u %08x %s< %s %d (%u us) [%s]' % (time_us, task, '  ' * len(stack), name,
+                                                  status, elapsed, MODULES.get(module, module)))
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__)
+    elf = Elf(sys.argv[1])
+    log = open(sys.argv[2], errors='replace') if len(sys.argv) == 3 else sys.stdin
+
+    totals = defaultdict(lambda: [0, 0, 0])
+    for records in read_dumps(log):
+        decode(records, elf, totals)
+
+    print('\n%-50s %8s %12s %12s' % ('function', 'calls', 'total us', 'self us'))
+    for name, (calls, total, own) in sorted(totals.items(), key=lambda t: -t[1][2]):
+        print('%-50s %8u %12u %12u' % (name, calls, total, own))
+
+
+if __name__ == '__main__':
+    main()
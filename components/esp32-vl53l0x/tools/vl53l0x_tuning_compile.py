@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""Compile a VL53L0X tuning table into a blob with longer I2C bursts.
+
+Usage: vl53l0x_tuning_compile.py [--keep-order] [--max-burst N]
+                                 [api/core/inc/vl53l0x_tuning.h
+                                  [api/core/inc/vl53l0x_tuning_blob.h]]
+
+The tuning table of vl53l0x_tuning.h writes one register per entry, so
+VL53L0X_load_tuning_settings() sends well over a hundred writes. The blob
+uses the same entry format (count, index, data...) with counts above 4, and
+is loaded by the same function.
+
+Writes between two page selects (0xFF) are sorted by register and runs of
+contiguous registers become one entry. The page select, 0x80 and 0x00 keep
+their place in the sequence: they switch the register map, power or start
+the device. A register written twice in a segment keeps its last value.
+--keep-order only merges entries that already follow each other.
+
+Before writing the blob, the register image both sequences leave on the
+device is compared, page by page, and so is the order of the map switching
+writes. The blob is not written if they differ.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_TABLE = os.path.join(TOOLS, '..', 'api', 'core', 'inc', 'vl53l0x_tuning.h')
+DEFAULT_BLOB = os.path.join(TOOLS, '..', 'api', 'core', 'inc', 'vl53l0x_tuning_blob.h')
+
+PAGE_SELECT = 0xFF
+# registers whose writes switch the register map or start/stop the device
+BARRIERS = (PAGE_SELECT, 0x80, 0x00)
+PARAMETER = 0xFF
+
+
+def parse_table(path, name='DefaultTuningSettings'):
+    """Bytes of the C array @name in @path"""
+    with open(path, encoding='utf-8', errors='replace') as f:
+        text = f.read()
+    match = re.search(r'\b%s\s*\[\s*\]\s*=\s*\{(.*?)\};' % name, text, re.S)
+    if not match:
+        raise ValueError('%s: no %s[] array' % (path, name))
+    body = re.sub(r'/\*.*?\*/', '', match.group(1), flags=re.S)
+    body = re.sub(r'//[^\n]*', '', body)
+    return [int(token, 0) for token in re.findall(r'0[xX][0-9a-fA-F]+|\d+', body)]
+
+
+def decode(data):
+    """Entries of a table: ('write', index, [bytes]) or ('param', select, [msb, lsb])"""
+    entries = []
+    i = 0
+    while data[i] != 0:
+        count = data[i]
+        if count == PARAMETER:
+            entries.append(('param', data[i + 1], data[i + 2:i + 4]))
+            i += 4
+        else:
+            entries.append(('write', data[i + 1], data[i + 2:i + 2 + count]))
+            i += 2 + count
+    return entries
+
+
+def encode(entries):
+    data = []
+    for kind, index, payload in entries:
+        data += [PARAMETER if kind == 'param' else len(payload), index] + list(payload)
+    return data + [0x00, 0x00, 0x00]
+
+
+def is_barrier(entry):
+    kind, index, payload = entry
+    return kind == 'param' or any(r in BARRIERS for r in range(index, index + len(payload)))
+
+
+def runs(writes, max_burst):
+    """Entries for the {register: value} of one segment, contiguous registers merged"""
+    entries = []
+    for index in sorted(writes):
+        last = entries[-1] if entries else None
+        if last and last[1] + len(last[2]) == index and len(last[2]) < max_burst:
+            last[2].append(writes[index])
+        else:
+            entries.append(('write', index, [writes[index]]))
+    return entries
+
+
+def compile_sorted(entries, max_burst):
+    out = []
+    segment = {}
+    for entry in entries:
+        if not is_barrier(entry):
+            for i, value in enumerate(entry[2]):
+                segment[entry[1] + i] = value
+            continue
+        out += runs(segment, max_burst)
+        segment = {}
+        # a page select nobody used before the next one
+        if out and entry[1] == PAGE_SELECT and entry[0] == 'write' and \
+                len(entry[2]) == 1 and out[-1][:2] == ('write', PAGE_SELECT):
+            out.pop()
+        out.append((entry[0], entry[1], list(entry[2])))
+    return out + runs(segment, max_burst)
+
+
+def compile_in_order(entries, max_burst):
+    out = []
+    for kind, index, payload in entries:
+        last = out[-1] if out else None
+        if kind == 'write' and last and last[0] == 'write' and \
+                not is_barrier((kind, index, payload)) and not is_barrier(last) and \
+                last[1] + len(last[2]) == index and len(last[2]) + len(payload) <= max_burst:
+            last[2].extend(payload)
+        else:
+            out.append((kind, index, list(payload)))
+    return out
+
+
+def replay(entries):
+    """Register image per page and the sequence of map switches and parameters"""
+    page = None
+    image = {}
+    switches = []
+    for kind, index, payload in entries:
+        if kind == 'param':
+            switches.append((kind, index, tuple(payload)))
+            continue
+        for i, value in enumerate(payload):
+            register = index + i
+            if register == PAGE_SELECT:
+                page = value
+            elif register in BARRIERS:
+                switches.append((page, register, value))
+            image[(page, register)] = value
+    return image, switches
+
+
+def c_array(name, data, entries):
+    lines = []
+    i = 0
+    for kind, _, payload in entries:
+        size = 4 if kind == 'param' else 2 + len(payload)
+        lines.append('\t' + ' '.join('0x%02X,' % b for b in data[i:i + size]))
+        i += size
+    lines.append('\t' + ', '.join('0x%02X' % b for b in data[i:]))
+    return 'uint8_t %s[] = {\n%s\n};\n' % (name, '\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('table', nargs='?', default=DEFAULT_TABLE)
+    parser.add_argument('blob', nargs='?', default=DEFAULT_BLOB)
+    parser.add_argument('--keep-order', action='store_true',
+                        help='only merge entries that already follow each other')
+    parser.add_argument('--max-burst', type=int, default=32,
+                        help='payload bytes per entry, at most 254 (default 32)')
+    args = parser.parse_args()
+    if not 1 <= args.max_burst <= 254:
+        parser.error('--max-burst must be 1..254')
+
+    entries = decode(parse_table(args.table))
+    if args.keep_order:
+        blob = compile_in_order(entries, args.max_burst)
+    else:
+        blob = compile_sorted(entries, args.max_burst)
+
+    if replay(blob) != replay(entries):
+        sys.exit('%s: compiled blob would leave another register image, not written' % args.table)
+
+    data = encode(blob)
+    with open(args.blob, 'w') as f:
+        f.write('/*\n'
+                ' * Generated from %s by tools/%s%s, do not edit.\n'
+                ' * %d register writes in %d entries instead of %d.\n'
+                ' * Same license as the source table.\n'
+                ' */\n\n'
+                '#ifndef _VL53L0X_TUNING_BLOB_H_\n'
+                '#define _VL53L0X_TUNING_BLOB_H_\n\n'
+                '#include "vl53l0x_def.h"\n\n\n'
+                '#ifdef __cplusplus\n'
+                'extern "C" {\n'
+                '#endif\n\n\n'
+                % (os.path.basename(args.table), os.path.basename(sys.argv[0]),
+                   ' --keep-order' if args.keep_order else '',
+                   sum(len(e[2]) for e in entries if e[0] == 'write'),
+                   len(blob), len(entries)))
+        f.write(c_array('DefaultTuningBlob', data, blob))
+        f.write('\n#ifdef __cplusplus\n'
+                '}\n'
+                '#endif\n\n'
+                '#endif /* _VL53L0X_TUNING_BLOB_H_ */\n')
+
+    print('%s: %d entries -> %d, %d bytes' % (args.blob, len(entries), len(blob), len(data)))
+
+
+if __name__ == '__main__':
+    main()
@@ -1,5 +1,6 @@
 
 #include "esp_log.h"
+#include "esp_pm.h"
 #include "project.h"
 #include "driver/i2c.h"
 
@@ -13,35 +14,78 @@ void app_main()
     init_http();
     init_camera();
     init_uart();
+    init_console();
 
-    VL53L0X_Dev_t tof_device;
-    if (!init_vl53l0x(&tof_device, I2C_PORT, PIN_SDA, PIN_SCL)) {
+#if CONFIG_PM_ENABLE
+    // light sleep only while the trigger watches, camera and upload need
+    // their clocks; no frequency scaling, the UART baud rates follow APB
+    esp_pm_lock_handle_t awake;
+    esp_pm_config_esp32_t pm_config = {
+      .max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+      .min_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+      .light_sleep_enable = true,
+    };
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "camera", &awake));
+    ESP_ERROR_CHECK(esp_pm_lock_acquire(awake));
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+#endif
+
+    static VL53L0X_Dev_t tof_device;
+    static VL53L0X_RangingService_t tof_ranging;
+    static vl53l0x_trigger_t tof_trigger;
+    if (!init_vl53l0x(&tof_device, I2C_PORT, PIN_SDA, PIN_SCL, PIN_GPIO1) ||
+        !vl53l0x_trigger_start(&tof_trigger, &tof_device, &tof_ranging, TRIGGER_DISTANCE_MM)) {
       ESP_LOGE(TAG, "Failed to initialize VL53L0X 1 :(");
       vTaskDelay(portMAX_DELAY);
     }
 
     char* response = (char*)malloc(MAX_HTTP_OUTPUT_BUFFER);
+    char command[16];
 
     while (1) {
       /* measurement */
       uint16_t result_mm = 0;
-      bool res = vl53l0x_read(&tof_device, &result_mm);
+      bool res = vl53l0x_trigger_poll(&tof_trigger, &result_mm);
       if (res) {
-        ESP_LOGI(TAG, "Range: %d [mm]", (int)result_mm);
-        if (result_mm < 350) {
-          ESP_LOGI(TAG, "Taking picture...");
-          camera_fb_t *pic = esp_camera_fb_get();
-
-          // // use pic->buf to access the image
-          ESP_LOGI(TAG, "Picture taken! Its size was: %zu bytes", pic->len);
-          size_t content_length = http_request_post(pic, response);
-          if (content_length > 0) {
-            uart_send(response, strlen(response)+1);
-          }
-          vTaskDelay(10000 / portTICK_RATE_MS);
-          }
+        ESP_LOGD(TAG, "Range: %d [mm]", (int)result_mm);
+        ESP_LOGI(TAG, "trigger decided %u us after the measurement ended",
+                 VL53L0X_GetTickCountUs() - tof_trigger.measured_us);
+        ESP_LOGI(TAG, "%u false triggers suppressed so far (capture + upload each)",
+                 tof_trigger.filter.suppressed);
+        ESP_LOGI(TAG, "Taking picture...");
+        camera_fb_t *pic = esp_camera_fb_get();
+
+        // // use pic->buf to access the image
+        ESP_LOGI(TAG, "Picture taken! Its size was: %zu bytes", pic->len);
+        size_t content_length = http_request_post(pic, response);
+        if (content_length > 0) {
+          uart_send(response, strlen(response)+1);
+        }
+        vTaskDelay(10000 / portTICK_RATE_MS);
+        vl53l0x_trigger_rearm(&tof_trigger);
+      }
+      // "stats", "profile", either with " clear", on the console
+      if (console_read_line(command, sizeof(command))) {
+        if (strncmp(command, "stats", 5) == 0) {
+          vl53l0x_print_stats(&tof_device, "tof",
+                              strcmp(command, "stats clear") == 0);
+          ESP_LOGI(TAG, "%u threshold wakeups", tof_trigger.wakes);
+        } else if (strncmp(command, "profile", 7) == 0) {
+          vl53l0x_print_profile(strcmp(command, "profile clear") == 0);
+        }
+      }
+      if (vl53l0x_trigger_watching(&tof_trigger)) {
+        // nothing runs until GPIO1 or the timeout, the chip light sleeps
+#if CONFIG_PM_ENABLE
+        esp_pm_lock_release(awake);
+#endif
+        vl53l0x_trigger_wait(&tof_trigger, TRIGGER_WATCH_MS);
+#if CONFIG_PM_ENABLE
+        esp_pm_lock_acquire(awake);
+#endif
+      } else {
+        vl53l0x_trigger_wait(&tof_trigger, TRIGGER_POLL_MS);
       }
-      vTaskDelay(600 / portTICK_RATE_MS);
     }
 
     free(response);
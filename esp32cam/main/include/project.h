@@ -6,7 +6,7 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
-#include "vl53l0x_platform.h"
+#include "vl53l0x.h"
 
 // #define WIFI_SSID   "Apt Big 10"
 // #define WIFI_PSWD   "B01l3rUp!"
@@ -22,6 +22,16 @@
 #define I2C_PORT  I2C_NUM_0
 #define PIN_SCL     GPIO_NUM_14
 #define PIN_SDA     GPIO_NUM_15
+// sensor GPIO1, data ready is polled over I2C unless it is wired
+#ifdef CONFIG_VL53L0X_GPIO1_WIRED
+#define PIN_GPIO1   CONFIG_VL53L0X_GPIO1_PIN
+#else
+#define PIN_GPIO1   GPIO_NUM_MAX
+#endif
+#define TRIGGER_DISTANCE_MM 350
+#define TRIGGER_POLL_MS   10
+// longest light sleep in watch mode, the console is read in between
+#define TRIGGER_WATCH_MS  1000
 
 #define PIN_UART_TX GPIO_NUM_12
 #define PIN_UART_RX GPIO_NUM_13
@@ -37,8 +47,62 @@ esp_err_t init_camera(void);
 void init_led(void);
 void init_uart(void);
 void uart_send(const char*, size_t);
-bool init_vl53l0x(VL53L0X_Dev_t*, i2c_port_t, gpio_num_t, gpio_num_t);
-bool vl53l0x_read(VL53L0X_Dev_t*, uint16_t*);
+void init_console(void);
+bool console_read_line(char*, size_t);
+// Streaming range filter, see vl53l0x_filter_update()
+#define VL53L0X_FILTER_WINDOW 5
+
+typedef struct {
+  uint16_t on_mm;                    // present below this median...
+  uint16_t off_mm;                   // ...until it rises above this one
+  uint32_t dwell_us;                 // median below on_mm this long first
+  uint16_t max_sigma_mm;             // samples with a larger sigma are dropped
+  uint8_t max_rejects;               // dropped in a row that empty the window
+  uint16_t window[VL53L0X_FILTER_WINDOW];
+  uint8_t count;
+  uint8_t next;
+  uint8_t rejects;
+  bool below;                        // median under on_mm, hysteresis state
+  uint32_t below_since_us;
+  bool present;
+  uint32_t lockout_us;               // of the unfiltered rule, for suppressed
+  bool raw_fired;
+  uint32_t raw_fired_us;
+  bool episode;                      // unfiltered rule fired, not decided yet
+  uint16_t median_mm;
+  uint32_t accepted;
+  uint32_t rejected;
+  uint32_t suppressed;               // single-sample triggers that were noise
+} vl53l0x_filter_t;
+
+// Presence trigger: a fast idle profile (or the sensor's threshold
+// interrupt, in watch mode) looks for candidates, a slow accurate one
+// confirms them
+typedef struct {
+  VL53L0X_Dev_t* dev;
+  VL53L0X_RangingService_t* service;
+  const vl53l0x_profile_t* profile;  // running now
+  uint16_t trigger_mm;
+  uint32_t generation;               // of the service, for next_sample
+  uint32_t next_sample;              // next service sample to look at
+  uint32_t signal_baseline;          // idle return signal, MCPS 16.16
+  uint8_t misses;
+  uint32_t wakes;                    // threshold interrupts in watch mode
+  bool gpio1_ok;                     // GPIO1 raised the interrupt, may watch
+  vl53l0x_filter_t filter;           // decides, over all profiles
+  bool fired;
+  uint16_t range_mm;                 // range that confirmed the trigger
+  uint32_t measured_us;              // end of the measurement that fired
+} vl53l0x_trigger_t;
+
+void vl53l0x_filter_init(vl53l0x_filter_t*, uint16_t, uint16_t, uint32_t, uint16_t, uint32_t);
+void vl53l0x_filter_reset(vl53l0x_filter_t*);
+bool vl53l0x_filter_update(vl53l0x_filter_t*, const VL53L0X_RangingSample_t*);
+bool vl53l0x_trigger_start(vl53l0x_trigger_t*, VL53L0X_Dev_t*, VL53L0X_RangingService_t*, uint16_t);
+bool vl53l0x_trigger_rearm(vl53l0x_trigger_t*);
+bool vl53l0x_trigger_poll(vl53l0x_trigger_t*, uint16_t*);
+bool vl53l0x_trigger_watching(const vl53l0x_trigger_t*);
+bool vl53l0x_trigger_wait(vl53l0x_trigger_t*, uint32_t);
 
 // void example_wifi_init(void);
 // esp_err_t example_espnow_init(void);
@@ -1,6 +1,8 @@
 
+#include <stdio.h>
 #include "driver/uart.h"
 #include "esp_log.h"
+#include "esp_sleep.h"
 #include "project.h"
 
 void init_uart(void) {
@@ -29,3 +31,36 @@ ESP_ERROR_CHECK(uart_driver_install(UART_NUM_2, uart_buffer_size,
 void uart_send(const char* str, size_t size) {
   uart_write_bytes(UART_NUM_2, str, size);
 }
+
+// Commands typed on the console (UART0), log output keeps going there
+void init_console(void) {
+  ESP_ERROR_CHECK(uart_driver_install(UART_NUM_0, 256, 0, 0, NULL, 0));
+#if CONFIG_PM_ENABLE
+  // While the trigger watches, the chip light sleeps and the UART does not
+  // receive. Three RX edges wake it, the character carrying them is lost:
+  // press Enter once (skipped as an empty line) before typing a command.
+  // The command runs when the watch wait ends, within TRIGGER_WATCH_MS.
+  ESP_ERROR_CHECK(uart_set_wakeup_threshold(UART_NUM_0, 3));
+  ESP_ERROR_CHECK(esp_sleep_enable_uart_wakeup(UART_NUM_0));
+#endif
+}
+
+// Never blocks. True once a whole line came in, without its line end.
+bool console_read_line(char* line, size_t size) {
+  static char buf[64];
+  static size_t len = 0;
+  uint8_t c;
+  while (uart_read_bytes(UART_NUM_0, &c, 1, 0) == 1) {
+    if (c == '\r' || c == '\n') {
+      if (len == 0)
+        continue;
+      buf[len] = '\0';
+      snprintf(line, size, "%s", buf);
+      len = 0;
+      return true;
+    }
+    if (len < sizeof(buf) - 1)
+      buf[len++] = c;
+  }
+  return false;
+}
@@ -0,0 +1,444 @@
+/**
+ * @file vl53l0x_trigger.c
+ * @brief Presence trigger of the camera: a range filter over the ranging
+ * service's samples, and the idle, watch and confirm profiles that feed it
+ */
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "vl53l0x_api.h"
+#include "vl53l0x_platform.h"
+#include "vl53l0x_ranging_service.h"
+
+#include "esp_log.h"
+
+#include "project.h"
+
+static const char *TAG = "VL53L0X";
+
+// Range filter: the median of the last few usable samples, with
+// hysteresis and a dwell time before presence is reported. Samples with a
+// range error or a sigma above max_sigma_mm are left out.
+static const uint8_t FILTER_MIN_SAMPLES = 3;
+
+void vl53l0x_filter_init(vl53l0x_filter_t* filter,
+                         uint16_t on_mm,
+                         uint16_t hysteresis_mm,
+                         uint32_t dwell_ms,
+                         uint16_t max_sigma_mm,
+                         uint32_t lockout_ms) {
+  memset(filter, 0, sizeof(*filter));
+  filter->on_mm = on_mm;
+  filter->off_mm = on_mm + hysteresis_mm;
+  filter->dwell_us = dwell_ms * 1000;
+  filter->max_sigma_mm = max_sigma_mm;
+  filter->max_rejects = FILTER_MIN_SAMPLES;
+  filter->lockout_us = lockout_ms * 1000;
+}
+
+// Forget the samples, the counters stay
+void vl53l0x_filter_reset(vl53l0x_filter_t* filter) {
+  filter->count = 0;
+  filter->next = 0;
+  filter->rejects = 0;
+  filter->below = false;
+  filter->present = false;
+  filter->episode = false;
+}
+
+static uint16_t filter_median(const vl53l0x_filter_t* filter) {
+  uint16_t sorted[VL53L0X_FILTER_WINDOW];
+  for (int i = 0; i < filter->count; i++) {
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > filter->window[i]; j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = filter->window[i];
+  }
+  return sorted[filter->count / 2];
+}
+
+// True while a target is present. The unfiltered rule is replayed alongside:
+// a single sample under on_mm fired it, then nothing for lockout_us. Each of
+// those firings that does not end in presence counts as suppressed.
+bool vl53l0x_filter_update(vl53l0x_filter_t* filter,
+                           const VL53L0X_RangingSample_t* sample) {
+  const VL53L0X_RangingMeasurementData_t* data = &sample->Data;
+  bool raw_below = data->RangeStatus == 0 &&
+                   data->RangeMilliMeter < filter->on_mm;
+
+  if (data->RangeStatus == 0 &&
+      (sample->SigmaMilliMeter >> 16) <= filter->max_sigma_mm) {
+    filter->window[filter->next] = data->RangeMilliMeter;
+    filter->next = (filter->next + 1) % VL53L0X_FILTER_WINDOW;
+    if (filter->count < VL53L0X_FILTER_WINDOW)
+      filter->count++;
+    filter->rejects = 0;
+    filter->accepted++;
+  } else {
+    filter->rejected++;
+    // nothing usable for a while, the target is gone
+    if (++filter->rejects >= filter->max_rejects) {
+      filter->count = 0;
+      filter->next = 0;
+    }
+  }
+
+  if (filter->count >= FILTER_MIN_SAMPLES) {
+    filter->median_mm = filter_median(filter);
+    if (!filter->below && filter->median_mm < filter->on_mm) {
+      filter->below = true;
+      filter->below_since_us = sample->Data.TimeStamp;
+    } else if (filter->below && filter->median_mm > filter->off_mm) {
+      filter->below = false;
+    }
+  } else if (filter->count == 0) {
+    filter->below = false;
+  }
+  filter->present = filter->below &&
+                    sample->Data.TimeStamp - filter->below_since_us >=
+                        filter->dwell_us;
+
+  if (raw_below && (!filter->raw_fired ||
+                    sample->Data.TimeStamp - filter->raw_fired_us >=
+                        filter->lockout_us)) {
+    filter->raw_fired = true;
+    filter->raw_fired_us = sample->Data.TimeStamp;
+    if (!filter->present)
+      filter->episode = true;
+  }
+  if (filter->present) {
+    filter->episode = false;
+  } else if (filter->episode && !filter->below && !raw_below) {
+    filter->episode = false;
+    filter->suppressed++;
+    ESP_LOGD(TAG, "filter: false trigger suppressed (%u so far)",
+             filter->suppressed);
+  }
+  return filter->present;
+}
+
+// Ranging profiles of the trigger controller. The idle profile is the
+// high-speed preset at TRIGGER_IDLE_PERIOD_MS, to sample often; the
+// confirm profile runs all steps with a long budget and tight sigma limit.
+// With GPIO1 wired and working, the watch profile replaces idle: the sensor ranges on
+// its own and only raises GPIO1 for a range under the candidate distance.
+// All keep the default VCSEL periods, a period change costs a phase
+// calibration on every switch.
+static const vl53l0x_profile_t VL53L0X_PROFILE_WATCH = {
+    .name = "watch",
+    .budget_us = 20000,
+    .period_ms = 50,
+    .pre_range_vcsel = 14,
+    .final_range_vcsel = 10,
+    .tcc = false,
+    .msrc = true,
+    .dss = true,
+    .pre_range = true,
+    .signal_limit_mcps = (FixPoint1616_t)(0.25 * 65536),
+    .sigma_limit_mm = (FixPoint1616_t)(32 * 65536),
+};
+
+static const uint32_t TRIGGER_IDLE_PERIOD_MS = 25;
+// built from the high-speed preset by vl53l0x_trigger_start()
+static vl53l0x_profile_t idle_profile;
+
+static const vl53l0x_profile_t VL53L0X_PROFILE_CONFIRM = {
+    .name = "confirm",
+    .budget_us = 50000,
+    .period_ms = 55,
+    .pre_range_vcsel = 14,
+    .final_range_vcsel = 10,
+    .tcc = true,
+    .msrc = true,
+    .dss = true,
+    .pre_range = true,
+    .signal_limit_mcps = (FixPoint1616_t)(0.25 * 65536),
+    .sigma_limit_mm = (FixPoint1616_t)(18 * 65536),
+};
+
+// Idle samples this much beyond the trigger distance (plus twice their
+// sigma) are worth confirming
+static const uint16_t TRIGGER_CANDIDATE_MARGIN_MM = 50;
+// A return signal this many times the idle baseline is a candidate as
+// well, even without a valid range
+static const uint32_t TRIGGER_SIGNAL_JUMP = 2;
+// Confirm samples in a row beyond the release distance to go back to idle
+static const uint8_t TRIGGER_CONFIRM_MISSES = 2;
+// Range filter between the samples and the trigger decision
+static const uint16_t TRIGGER_HYSTERESIS_MM = 30;
+static const uint32_t TRIGGER_DWELL_MS = 100;
+static const uint16_t TRIGGER_MAX_SIGMA_MM = 25;
+// camera busy after a capture, the unfiltered rule could not fire meanwhile
+static const uint32_t TRIGGER_LOCKOUT_MS = 10000;
+// GPIO1 check at start: the interrupt is due this long after the budget
+static const uint32_t TRIGGER_GPIO1_MARGIN_MS = 20;
+
+// Device locked. Continuous timed ranging with GPIO1 active only for a
+// range under threshold_mm, nothing to read out until then.
+static VL53L0X_Error watch_start(VL53L0X_Dev_t* vl53l0x_dev,
+                                 uint16_t threshold_mm, uint32_t period_ms) {
+  FixPoint1616_t threshold = (FixPoint1616_t)threshold_mm << 16;
+  VL53L0X_Error status = VL53L0X_SetGpioConfig(
+      vl53l0x_dev, 0, VL53L0X_DEVICEMODE_CONTINUOUS_TIMED_RANGING,
+      VL53L0X_GPIOFUNCTIONALITY_THRESHOLD_CROSSED_LOW,
+      VL53L0X_INTERRUPTPOLARITY_LOW);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetInterruptThresholds(
+        vl53l0x_dev, VL53L0X_DEVICEMODE_CONTINUOUS_TIMED_RANGING, threshold,
+        threshold);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetDeviceMode(vl53l0x_dev,
+                                   VL53L0X_DEVICEMODE_CONTINUOUS_TIMED_RANGING);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetInterMeasurementPeriodMilliSeconds(vl53l0x_dev,
+                                                           period_ms);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_StartMeasurement(vl53l0x_dev);
+  return status;
+}
+
+// Device locked. Back to data ready on GPIO1, as the ranging service needs.
+static VL53L0X_Error watch_stop(VL53L0X_Dev_t* vl53l0x_dev) {
+  VL53L0X_Error status = VL53L0X_StopMeasurement(vl53l0x_dev);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetGpioConfig(vl53l0x_dev, 0,
+                                   VL53L0X_DEVICEMODE_SINGLE_RANGING,
+                                   VL53L0X_GPIOFUNCTIONALITY_NEW_MEASURE_READY,
+                                   VL53L0X_INTERRUPTPOLARITY_LOW);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetDeviceMode(vl53l0x_dev,
+                                   VL53L0X_DEVICEMODE_SINGLE_RANGING);
+  return status;
+}
+
+static bool trigger_switch(vl53l0x_trigger_t* trigger,
+                           const vl53l0x_profile_t* profile) {
+  VL53L0X_Error status = VL53L0X_ERROR_NONE;
+  // idle and confirm run the ranging service at their own period, between
+  // the two the service switches in place and keeps its task
+  bool in_place = trigger->profile != NULL &&
+                  trigger->profile != &VL53L0X_PROFILE_WATCH &&
+                  profile != &VL53L0X_PROFILE_WATCH;
+  bool ok;
+  if (trigger->profile == &VL53L0X_PROFILE_WATCH) {
+    VL53L0X_SetInterruptWakeup(trigger->dev, 0);
+    VL53L0X_LockDevice(trigger->dev);
+    status = watch_stop(trigger->dev);
+    VL53L0X_UnlockDevice(trigger->dev);
+  } else if (trigger->profile != NULL && !in_place) {
+    VL53L0X_StopRangingService(trigger->service);
+  }
+  trigger->profile = profile;
+  // done with the old profile's samples: an in-place switch tells where
+  // the new ones start, a restarted service is a new generation and
+  // vl53l0x_trigger_poll() starts over at its first sample
+  trigger->next_sample = VL53L0X_GetRangingCount(trigger->service);
+  trigger->misses = 0;
+  ESP_LOGD(TAG, "trigger: %s profile", profile->name);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "trigger_switch");
+    return false;
+  }
+  if (in_place)
+    return vl53l0x_switch_profile(trigger->dev, trigger->service, profile, 0,
+                                  &trigger->next_sample);
+  if (profile != &VL53L0X_PROFILE_WATCH)
+    return vl53l0x_start_profile(trigger->dev, trigger->service, profile, 0);
+
+  VL53L0X_LockDevice(trigger->dev);
+  ok = vl53l0x_set_profile(trigger->dev, profile);
+  if (ok)
+    status = watch_start(trigger->dev,
+                         trigger->trigger_mm + TRIGGER_CANDIDATE_MARGIN_MM,
+                         profile->period_ms);
+  VL53L0X_UnlockDevice(trigger->dev);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "trigger_switch");
+    return false;
+  }
+  return ok && VL53L0X_SetInterruptWakeup(trigger->dev, 1) ==
+                   VL53L0X_ERROR_NONE;
+}
+
+// Watch where GPIO1 has been seen to work, look at idle samples otherwise
+static const vl53l0x_profile_t* trigger_idle_profile(
+    const vl53l0x_trigger_t* trigger) {
+  return trigger->gpio1_ok ? &VL53L0X_PROFILE_WATCH : &idle_profile;
+}
+
+// A configured interrupt pin need not be wired: one single measurement has
+// to raise GPIO1 within its timing budget before watch mode is trusted.
+static bool trigger_check_gpio1(vl53l0x_trigger_t* trigger) {
+  VL53L0X_Dev_t* vl53l0x_dev = trigger->dev;
+  uint32_t budget_us = 0;
+  VL53L0X_Error status;
+  bool raised;
+
+  if (!vl53l0x_dev->gpio1.Enabled)
+    return false;
+  VL53L0X_LockDevice(vl53l0x_dev);
+  status = VL53L0X_GetMeasurementTimingBudgetMicroSeconds(vl53l0x_dev,
+                                                          &budget_us);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_SetDeviceMode(vl53l0x_dev,
+                                   VL53L0X_DEVICEMODE_SINGLE_RANGING);
+  if (status == VL53L0X_ERROR_NONE)
+    status = VL53L0X_StartMeasurement(vl53l0x_dev);
+  VL53L0X_UnlockDevice(vl53l0x_dev);
+  if (status != VL53L0X_ERROR_NONE) {
+    vl53l0x_print_error(status, "trigger_check_gpio1");
+    return false;
+  }
+  // the wait must not hold the lock
+  raised = VL53L0X_WaitInterrupt(vl53l0x_dev,
+                                 budget_us / 1000 + TRIGGER_GPIO1_MARGIN_MS) ==
+           VL53L0X_ERROR_NONE;
+  VL53L0X_LockDevice(vl53l0x_dev);
+  status = VL53L0X_ClearInterruptMask(vl53l0x_dev, 0);
+  VL53L0X_UnlockDevice(vl53l0x_dev);
+  if (status != VL53L0X_ERROR_NONE)
+    vl53l0x_print_error(status, "trigger_check_gpio1");
+  if (!raised)
+    ESP_LOGW(TAG, "trigger: no interrupt on GPIO1, polling instead");
+  return raised && status == VL53L0X_ERROR_NONE;
+}
+
+// Runs the service of vl53l0x_dev, which must not be ranging yet
+bool vl53l0x_trigger_start(vl53l0x_trigger_t* trigger,
+                           VL53L0X_Dev_t* vl53l0x_dev,
+                           VL53L0X_RangingService_t* service,
+                           uint16_t trigger_mm) {
+  memset(trigger, 0, sizeof(*trigger));
+  trigger->dev = vl53l0x_dev;
+  trigger->service = service;
+  trigger->trigger_mm = trigger_mm;
+  idle_profile = *vl53l0x_preset(VL53L0X_PRESET_HIGH_SPEED);
+  idle_profile.name = "idle";
+  idle_profile.period_ms = TRIGGER_IDLE_PERIOD_MS;
+  vl53l0x_filter_init(&trigger->filter, trigger_mm, TRIGGER_HYSTERESIS_MM,
+                      TRIGGER_DWELL_MS, TRIGGER_MAX_SIGMA_MM,
+                      TRIGGER_LOCKOUT_MS);
+  trigger->gpio1_ok = trigger_check_gpio1(trigger);
+  return trigger_switch(trigger, trigger_idle_profile(trigger));
+}
+
+// Back to the idle profile, after a trigger has been handled
+bool vl53l0x_trigger_rearm(vl53l0x_trigger_t* trigger) {
+  trigger->fired = false;
+  vl53l0x_filter_reset(&trigger->filter);
+  if (trigger->profile == &idle_profile) {
+    // what was measured during the lockout is stale
+    trigger->next_sample = VL53L0X_GetRangingCount(trigger->service);
+    return true;
+  }
+  return trigger_switch(trigger, trigger_idle_profile(trigger));
+}
+
+// True while the trigger waits for GPIO1 and has nothing to poll
+bool vl53l0x_trigger_watching(const vl53l0x_trigger_t* trigger) {
+  return trigger->profile == &VL53L0X_PROFILE_WATCH;
+}
+
+// Blocks up to timeout_ms (VL53L0X_WAIT_FOREVER for no limit) in watch
+// mode, the chip can light sleep meanwhile. Once GPIO1 reports a range
+// under the candidate distance, switches to the confirm profile and
+// returns true: vl53l0x_trigger_poll() takes it from there. Outside watch
+// mode, just waits timeout_ms. A timeout while the sensor reports its
+// interrupt means GPIO1 stopped working, the trigger polls from then on.
+bool vl53l0x_trigger_wait(vl53l0x_trigger_t* trigger, uint32_t timeout_ms) {
+  VL53L0X_Error status;
+  uint8_t ready = 0;
+
+  if (!vl53l0x_trigger_watching(trigger)) {
+    vTaskDelay(timeout_ms / portTICK_RATE_MS);
+    return false;
+  }
+  status = VL53L0X_WaitInterrupt(trigger->dev, timeout_ms);
+  if (status == VL53L0X_ERROR_TIME_OUT) {
+    VL53L0X_LockDevice(trigger->dev);
+    status = VL53L0X_GetMeasurementDataReady(trigger->dev, &ready);
+    VL53L0X_UnlockDevice(trigger->dev);
+    if (status != VL53L0X_ERROR_NONE || !ready)
+      return false;
+    // the pin level is checked first, a late edge is not taken for a fault
+    if (VL53L0X_WaitInterrupt(trigger->dev, 0) != VL53L0X_ERROR_NONE) {
+      ESP_LOGW(TAG, "trigger: interrupt pending without GPIO1, polling");
+      trigger->gpio1_ok = false;
+      trigger_switch(trigger, &idle_profile);
+      return false;
+    }
+  } else if (status != VL53L0X_ERROR_NONE) {
+    return false;
+  }
+  trigger->wakes++;
+  return trigger_switch(trigger, &VL53L0X_PROFILE_CONFIRM);
+}
+
+static bool trigger_candidate(vl53l0x_trigger_t* trigger,
+                              const VL53L0X_RangingSample_t* sample) {
+  const VL53L0X_RangingMeasurementData_t* data = &sample->Data;
+  uint32_t sigma_mm = sample->SigmaMilliMeter >> 16;
+  uint32_t signal = data->SignalRateRtnMegaCps;
+  // range status 1 is a sigma fail, the range is still a hint
+  bool ranged = data->RangeStatus == 0 || data->RangeStatus == 1;
+
+  if (ranged && data->RangeMilliMeter <
+                    trigger->trigger_mm + TRIGGER_CANDIDATE_MARGIN_MM +
+                        2 * sigma_mm)
+    return true;
+  if (trigger->signal_baseline != 0 &&
+      signal > TRIGGER_SIGNAL_JUMP * trigger->signal_baseline)
+    return true;
+  // 1/8 weight exponential average of the empty bin's return
+  if (trigger->signal_baseline == 0)
+    trigger->signal_baseline = signal;
+  else
+    trigger->signal_baseline += ((int32_t)signal -
+                                 (int32_t)trigger->signal_baseline) / 8;
+  return false;
+}
+
+// Never blocks. Feeds the samples published since the last call through
+// the range filter and switches profiles as needed. True once the filter
+// reports a target closer than the trigger distance, until
+// vl53l0x_trigger_rearm().
+bool vl53l0x_trigger_poll(vl53l0x_trigger_t* trigger,
+                          uint16_t* pRangeMilliMeter) {
+  VL53L0X_RangingSample_t sample;
+  const VL53L0X_RangingMeasurementData_t* data = &sample.Data;
+  uint32_t generation = VL53L0X_GetRangingGeneration(trigger->service);
+
+  if (generation != trigger->generation) {
+    trigger->generation = generation;
+    trigger->next_sample = 0;
+  }
+  while (!trigger->fired &&
+         trigger->next_sample < VL53L0X_GetRangingCount(trigger->service)) {
+    if (VL53L0X_GetRangingSample(trigger->service, trigger->next_sample++,
+                                 &sample) != VL53L0X_ERROR_NONE)
+      continue;  // overwritten, the newer ones follow
+
+    if (vl53l0x_filter_update(&trigger->filter, &sample)) {
+      trigger->fired = true;
+      trigger->range_mm = trigger->filter.median_mm;
+      trigger->measured_us = data->TimeStamp;
+    } else if (trigger->profile == &idle_profile) {
+      if (trigger_candidate(trigger, &sample)) {
+        trigger_switch(trigger, &VL53L0X_PROFILE_CONFIRM);
+        break;
+      }
+    } else if (data->RangeStatus == 0 &&
+               data->RangeMilliMeter <= trigger->filter.off_mm) {
+      trigger->misses = 0;
+    } else if (++trigger->misses >= TRIGGER_CONFIRM_MISSES) {
+      trigger_switch(trigger, trigger_idle_profile(trigger));
+      break;
+    }
+  }
+  if (trigger->fired)
+    *pRangeMilliMeter = trigger->range_mm;
+  return trigger->fired;
+}
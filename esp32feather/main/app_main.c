@@ -20,20 +20,42 @@ static const char *TAG = "app_main";
 
 VL53L0X_Dev_t tof_device1;
 VL53L0X_Dev_t tof_device2;
+VL53L0X_RangingService_t tof_ranging1;
+VL53L0X_RangingService_t tof_ranging2;
+// fill_levels[0] non recyclable (tof_device1), [1] recyclable (tof_device2)
+vl53l0x_level_t fill_levels[2];
+vl53l0x_sampler_t fill_sampler;
 
-void task(const char* message) {
-    lcd_write_instruction(0b00000001);
-    //lcd_clear();
-    vTaskDelay(5 / portTICK_PERIOD_MS);
-    lcd_write_instruction(0b10000000);
-    // lcd_go_to_line1();
-    vTaskDelay(5 / portTICK_PERIOD_MS);
-    lcd_print((uint8_t*)message);
-    mcpwm_servo_control(message[0]);
+// A fill level measured after a lid cycle, from the level sampler to
+// report_task()
+typedef struct {
+  char compartment;                  // 'R' recyclable, else non recyclable
+  bool ok;
+  uint16_t range_mm;
+} fill_report_t;
+
+static QueueHandle_t fill_reports;
+
+// vl53l0x_read_done_t, called by the level sampler: hands over, never blocks
+static void fill_level_done(void* arg, bool ok, uint16_t range_mm) {
+  fill_report_t report = {
+    .compartment = (char)(intptr_t)arg,
+    .ok = ok,
+    .range_mm = range_mm,
+  };
+  if (xQueueSend(fill_reports, &report, 0) != pdTRUE)
+    ESP_LOGW(TAG, "fill level report dropped");
+}
+
+// Shows and uploads the fill levels, off the UART and sampler tasks
+static void report_task(void* arg) {
+  fill_report_t report;
+  while (1) {
+    xQueueReceive(fill_reports, &report, portMAX_DELAY);
     char capacity_message[16];
-    if (message[0] == 'R') {
-      uint16_t result_mm1 = 0;
-      bool res1 = vl53l0x_read(&tof_device2, &result_mm1);
+    if (report.compartment == 'R') {
+      uint16_t result_mm1 = report.range_mm;
+      bool res1 = report.ok;
       if(res1) {
         printf("Measured: %d[mm]", (int)result_mm1);
         int a = ((530 - (float)result_mm1) / 530) * 100;
@@ -50,8 +72,8 @@ void task(const char* message) {
       }
     }
     else {
-      uint16_t result_mm2 = 0;
-      bool res2 = vl53l0x_read(&tof_device1, &result_mm2);
+      uint16_t result_mm2 = report.range_mm;
+      bool res2 = report.ok;
       if(res2) {
         printf("Measured: %d[mm]", (int)result_mm2);
         int b = ((530 - (float)result_mm2) / 530) * 100;
@@ -69,7 +91,61 @@ void task(const char* message) {
     }
     lcd_go_to_line2();
     lcd_print((uint8_t*)capacity_message);
-    vTaskDelay(1000 / portTICK_RATE_MS);
+  }
+}
+
+void task(const char* message) {
+    // "stats" or "stats clear" from the serial line, not a classification
+    if (strncmp(message, "stats", 5) == 0) {
+      bool clear = strncmp(message, "stats clear", 11) == 0;
+      vl53l0x_print_stats(&tof_device1, "non recyclable", clear);
+      vl53l0x_print_stats(&tof_device2, "recyclable", clear);
+      // the cached estimates, as the sampler last made them
+      for (int i = 0; i < 2; i++) {
+        const char* name = i == 1 ? "recyclable" : "non recyclable";
+        uint16_t level_mm;
+        if (vl53l0x_level_get(&fill_levels[i], FILL_MAX_AGE_MS, &level_mm))
+          ESP_LOGI(TAG, "%s: fill level at %u mm", name, level_mm);
+        else
+          ESP_LOGI(TAG, "%s: no recent fill level", name);
+      }
+      return;
+    }
+    // "profile" or "profile clear", I2C traffic per VL53L0X API function
+    if (strncmp(message, "profile", 7) == 0) {
+      vl53l0x_print_profile(strncmp(message, "profile clear", 13) == 0);
+      return;
+    }
+    // "preset long-range" and so on, switches both fill sensors
+    if (strncmp(message, "preset ", 7) == 0) {
+      char name[16];
+      snprintf(name, sizeof(name), "%s", message + 7);
+      // without the line end of the serial console
+      name[strcspn(name, "\r\n")] = '\0';
+      const vl53l0x_profile_t* preset = vl53l0x_preset_named(name);
+      if (preset == NULL) {
+        ESP_LOGW(TAG, "no such preset: %s", name);
+        return;
+      }
+      ESP_LOGI(TAG, "fill sensors: %s preset", preset->name);
+      vl53l0x_switch_profile(&tof_device1, &tof_ranging1, preset, RANGING_PERIOD_MS, NULL);
+      vl53l0x_switch_profile(&tof_device2, &tof_ranging2, preset, RANGING_PERIOD_MS, NULL);
+      return;
+    }
+    lcd_write_instruction(0b00000001);
+    //lcd_clear();
+    vTaskDelay(5 / portTICK_PERIOD_MS);
+    lcd_write_instruction(0b10000000);
+    // lcd_go_to_line1();
+    vTaskDelay(5 / portTICK_PERIOD_MS);
+    lcd_print((uint8_t*)message);
+    mcpwm_servo_control(message[0]);
+    // the lid is closed again: measure the bin as it is now, not what the
+    // level window held from before or while the lid was open. Nothing
+    // waits here, report_task() shows and uploads the level once it is in.
+    vl53l0x_level_restart(&fill_levels[message[0] == 'R' ? 1 : 0],
+                          FILL_SETTLE_MS, fill_level_done,
+                          (void*)(intptr_t)message[0]);
 }
 
 void app_main(void)
@@ -86,20 +162,30 @@ void app_main(void)
     // init_lcd();
     connect2wifi();
 
-    if (!init_vl53l0x(&tof_device2, I2C_PORT2, PIN_SDA2, PIN_SCL2)) {
+    if (!init_vl53l0x(&tof_device2, I2C_PORT2, PIN_SDA2, PIN_SCL2, PIN_GPIO1_2) ||
+        !vl53l0x_start_profile(&tof_device2, &tof_ranging2,
+                               vl53l0x_preset(FILL_PRESET), RANGING_PERIOD_MS)) {
       ESP_LOGE(TAG, "Failed to initialize VL53L0X 2 :(");
       //vTaskDelay(portMAX_DELAY);
     } else {
       ESP_LOGI(TAG, "VL53L0X 2 initialized");
     }
 
-    if (!init_vl53l0x(&tof_device1, I2C_PORT1, PIN_SDA1, PIN_SCL1)) {
+    if (!init_vl53l0x(&tof_device1, I2C_PORT1, PIN_SDA1, PIN_SCL1, PIN_GPIO1_1) ||
+        !vl53l0x_start_profile(&tof_device1, &tof_ranging1,
+                               vl53l0x_preset(FILL_PRESET), RANGING_PERIOD_MS)) {
       ESP_LOGE(TAG, "Failed to initialize VL53L0X 1 :(");
       //vTaskDelay(portMAX_DELAY);
     } else {
       ESP_LOGI(TAG, "VL53L0X 1 initialized");
     }
 
+    fill_reports = xQueueCreate(4, sizeof(fill_report_t));
+    xTaskCreate(report_task, "fill_report", 4096, NULL, 5, NULL);
+    vl53l0x_level_init(&fill_levels[0], &tof_ranging1, FILL_OUTLIER_MM);
+    vl53l0x_level_init(&fill_levels[1], &tof_ranging2, FILL_OUTLIER_MM);
+    vl53l0x_level_start(&fill_sampler, fill_levels, 2, FILL_SAMPLE_MS);
+
     init_uart();
 
     create_task(task);
@@ -2,7 +2,7 @@
 
 #include "driver/gpio.h"
 #include "driver/i2c.h"
-#include "vl53l0x_platform.h"
+#include "vl53l0x.h"
 
 #define PIN_LCD_D7  GPIO_NUM_14
 #define PIN_LCD_D6  GPIO_NUM_32
@@ -25,6 +25,28 @@
 #define I2C_PORT2 I2C_NUM_1
 #define PIN_SDA2 GPIO_NUM_4
 #define PIN_SCL2 GPIO_NUM_25
+// sensor GPIO1 lines, data ready is polled over I2C unless they are wired
+#ifdef CONFIG_VL53L0X_GPIO1_WIRED
+#define PIN_GPIO1_1 CONFIG_VL53L0X_GPIO1_PIN_1
+#define PIN_GPIO1_2 CONFIG_VL53L0X_GPIO1_PIN_2
+#else
+#define PIN_GPIO1_1 GPIO_NUM_MAX
+#define PIN_GPIO1_2 GPIO_NUM_MAX
+#endif
+// a fill level only changes with a lid cycle: one sample a second keeps
+// each sensor ranging ~3% of the time
+#define RANGING_PERIOD_MS 1000
+// bin fill levels: up to ~0.5 m into a dark bin, the default preset's
+// signal limit drops the weak returns of a dark lining
+#define FILL_PRESET       VL53L0X_PRESET_LONG_RANGE
+// fill estimates: updated every FILL_SAMPLE_MS from the last
+// VL53L0X_LEVEL_WINDOW samples; after the lid closed, a new one takes three
+// valid samples and a sampler round, reported once in or after
+// FILL_SETTLE_MS; estimates older than FILL_MAX_AGE_MS are not shown
+#define FILL_SAMPLE_MS    1000
+#define FILL_OUTLIER_MM   25
+#define FILL_SETTLE_MS    6000
+#define FILL_MAX_AGE_MS   5000
 
 #define PIN_MOTOR1 GPIO_NUM_21
 #define PIN_MOTOR2 GPIO_NUM_26
@@ -57,5 +79,42 @@ void http_get_test2(int);
 void init_uart(void);
 void create_task(void(*task)(const char*));
 
-bool init_vl53l0x(VL53L0X_Dev_t*, i2c_port_t, gpio_num_t, gpio_num_t);
-bool vl53l0x_read(VL53L0X_Dev_t*, uint16_t*);
+// Slowly changing distance from a ranging service, see vl53l0x_level_start()
+#define VL53L0X_LEVEL_WINDOW 8
+
+typedef struct {
+  const VL53L0X_RangingService_t* service;
+  uint16_t outlier_mm;               // samples kept within this of the median
+  uint32_t generation;               // of the service, for next_sample
+  uint32_t next_sample;              // next service sample to take in
+  volatile uint32_t epoch;           // bumped by vl53l0x_level_restart()
+  volatile uint32_t epoch_us;        // when the epoch started
+  vl53l0x_read_done_t done;          // of the last vl53l0x_level_restart()
+  void* done_arg;
+  uint32_t done_timeout_ms;
+  vl53l0x_read_done_t pending;       // done of window_epoch, not called yet
+  void* pending_arg;
+  uint32_t pending_until_us;
+  uint32_t window_epoch;             // epoch of the samples in the window
+  bool before_epoch;                 // dropping samples measured earlier
+  uint16_t window[VL53L0X_LEVEL_WINDOW];
+  uint8_t count;
+  uint8_t next;
+  volatile uint32_t sequence;        // odd while the estimate is written
+  uint16_t estimate_mm;
+  uint32_t estimate_epoch;           // window_epoch of the estimate
+  uint32_t updated_us;
+  bool valid;
+} vl53l0x_level_t;
+
+typedef struct {
+  vl53l0x_level_t* levels;
+  uint8_t count;
+  uint32_t interval_ms;
+  TaskHandle_t task;
+} vl53l0x_sampler_t;
+
+void vl53l0x_level_init(vl53l0x_level_t*, const VL53L0X_RangingService_t*, uint16_t);
+bool vl53l0x_level_start(vl53l0x_sampler_t*, vl53l0x_level_t*, uint8_t, uint32_t);
+bool vl53l0x_level_get(const vl53l0x_level_t*, uint32_t, uint16_t*);
+void vl53l0x_level_restart(vl53l0x_level_t*, uint32_t, vl53l0x_read_done_t, void*);
@@ -0,0 +1,222 @@
+/**
+ * @file vl53l0x_level.c
+ * @brief Fill level sampler: a slowly changing distance from each bin
+ * sensor's ranging service, filtered in a task of its own
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "vl53l0x_platform.h"
+#include "vl53l0x_ranging_service.h"
+
+#include "esp_log.h"
+
+#include "project.h"
+
+static const char *TAG = "VL53L0X";
+// below the ranging tasks, the level sampler only reads their rings
+static const UBaseType_t VL53L0X_LEVEL_PRIORITY = 4;
+static const uint32_t VL53L0X_LEVEL_STACK = 2048;
+
+// Level sampler: a slowly changing distance (a bin's fill level) from a
+// running ranging service. The window holds the last valid samples; the
+// estimate is the mean of those within outlier_mm of their median, and is
+// only updated while they are the majority.
+static const uint8_t LEVEL_MIN_SAMPLES = 3;
+
+void vl53l0x_level_init(vl53l0x_level_t* level,
+                        const VL53L0X_RangingService_t* service,
+                        uint16_t outlier_mm) {
+  memset(level, 0, sizeof(*level));
+  level->service = service;
+  level->outlier_mm = outlier_mm;
+}
+
+static void level_publish(vl53l0x_level_t* level, uint16_t estimate_mm) {
+  // odd while written, as the ranging service's ring slots
+  level->sequence++;
+  __sync_synchronize();
+  level->estimate_mm = estimate_mm;
+  level->estimate_epoch = level->window_epoch;
+  level->updated_us = VL53L0X_GetTickCountUs();
+  level->valid = true;
+  __sync_synchronize();
+  level->sequence++;
+}
+
+static void level_update(vl53l0x_level_t* level) {
+  VL53L0X_RangingSample_t sample;
+  uint16_t sorted[VL53L0X_LEVEL_WINDOW];
+  uint32_t epoch = level->epoch;
+  uint32_t generation = VL53L0X_GetRangingGeneration(level->service);
+  uint32_t published = VL53L0X_GetRangingCount(level->service);
+  uint32_t sum = 0;
+  uint8_t inliers = 0;
+  uint16_t median;
+  bool added = false;
+
+  // pairs with the barrier in vl53l0x_level_restart(), for epoch_us
+  __sync_synchronize();
+  // vl53l0x_level_restart(): start over with what is measured from then on
+  if (epoch != level->window_epoch) {
+    level->window_epoch = epoch;
+    level->count = 0;
+    level->next = 0;
+    level->before_epoch = true;
+    // a callback still pending for the last epoch is dropped
+    level->pending = level->done;
+    level->pending_arg = level->done_arg;
+    level->pending_until_us = level->epoch_us + level->done_timeout_ms * 1000;
+  }
+  // a restarted service numbers its samples from 0 again, a preset switch
+  // keeps the service and its numbering
+  if (generation != level->generation) {
+    level->generation = generation;
+    level->next_sample = 0;
+  }
+  // the ring only keeps the newest samples, older ones are gone anyway
+  if (published - level->next_sample > VL53L0X_RANGING_RING_SIZE)
+    level->next_sample = published - VL53L0X_RANGING_RING_SIZE;
+  for (; level->next_sample < published; level->next_sample++) {
+    if (VL53L0X_GetRangingSample(level->service, level->next_sample,
+                                 &sample) != VL53L0X_ERROR_NONE)
+      continue;
+    // samples come in order, drop them up to the first one of the epoch
+    if (level->before_epoch) {
+      if ((int32_t)(sample.Data.TimeStamp - level->epoch_us) < 0)
+        continue;
+      level->before_epoch = false;
+    }
+    if (sample.Data.RangeStatus != 0)
+      continue;
+    level->window[level->next] = sample.Data.RangeMilliMeter;
+    level->next = (level->next + 1) % VL53L0X_LEVEL_WINDOW;
+    if (level->count < VL53L0X_LEVEL_WINDOW)
+      level->count++;
+    added = true;
+  }
+  if (!added || level->count < LEVEL_MIN_SAMPLES)
+    return;
+
+  memcpy(sorted, level->window, level->count * sizeof(sorted[0]));
+  for (int i = 1; i < level->count; i++) {
+    uint16_t v = sorted[i];
+    int j = i;
+    for (; j > 0 && sorted[j - 1] > v; j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = v;
+  }
+  median = sorted[level->count / 2];
+  for (int i = 0; i < level->count; i++) {
+    if (abs((int)sorted[i] - (int)median) <= level->outlier_mm) {
+      sum += sorted[i];
+      inliers++;
+    }
+  }
+  if (2 * inliers > level->count)
+    level_publish(level, (sum + inliers / 2) / inliers);
+}
+
+// The callback of vl53l0x_level_restart(), once the epoch has an estimate
+// or ran out of time. Only the sampler task writes the estimate.
+static void level_report(vl53l0x_level_t* level) {
+  vl53l0x_read_done_t done = level->pending;
+
+  if (done == NULL)
+    return;
+  if (level->valid && level->estimate_epoch == level->window_epoch) {
+    level->pending = NULL;
+    done(level->pending_arg, true, level->estimate_mm);
+  } else if ((int32_t)(VL53L0X_GetTickCountUs() - level->pending_until_us) >=
+             0) {
+    level->pending = NULL;
+    done(level->pending_arg, false, 0);
+  }
+}
+
+static void level_task(void* arg) {
+  vl53l0x_sampler_t* sampler = (vl53l0x_sampler_t*)arg;
+  TickType_t wake = xTaskGetTickCount();
+  while (1) {
+    for (int i = 0; i < sampler->count; i++) {
+      level_update(&sampler->levels[i]);
+      level_report(&sampler->levels[i]);
+    }
+    vTaskDelayUntil(&wake, sampler->interval_ms / portTICK_RATE_MS);
+  }
+}
+
+// Updates every level every interval_ms in a task of its own, the levels'
+// ranging services must be running. Readers use vl53l0x_level_get(), or
+// vl53l0x_level_restart() with a callback after the scene changed.
+bool vl53l0x_level_start(vl53l0x_sampler_t* sampler,
+                         vl53l0x_level_t* levels,
+                         uint8_t count,
+                         uint32_t interval_ms) {
+  sampler->levels = levels;
+  sampler->count = count;
+  sampler->interval_ms = interval_ms;
+  if (xTaskCreate(level_task, "vl53l0x_level", VL53L0X_LEVEL_STACK, sampler,
+                  VL53L0X_LEVEL_PRIORITY, &sampler->task) != pdPASS) {
+    ESP_LOGE(TAG, "level sampler task not created");
+    return false;
+  }
+  return true;
+}
+
+// Consistent copy of the estimate, the sampler task may be publishing
+static void level_read(const vl53l0x_level_t* level, uint16_t* estimate_mm,
+                       uint32_t* updated_us, uint32_t* epoch, bool* valid) {
+  uint32_t sequence;
+
+  do {
+    sequence = level->sequence;
+    __sync_synchronize();
+    *estimate_mm = level->estimate_mm;
+    *updated_us = level->updated_us;
+    *epoch = level->estimate_epoch;
+    *valid = level->valid;
+    __sync_synchronize();
+  } while ((sequence & 1) || level->sequence != sequence);
+}
+
+// Never blocks, never touches the bus. False until the first estimate and
+// when none was made for max_age_ms (sensor failing or blocked).
+bool vl53l0x_level_get(const vl53l0x_level_t* level,
+                       uint32_t max_age_ms,
+                       uint16_t* pRangeMilliMeter) {
+  uint32_t updated_us;
+  uint32_t epoch;
+  uint16_t estimate_mm;
+  bool valid;
+
+  level_read(level, &estimate_mm, &updated_us, &epoch, &valid);
+  if (!valid || VL53L0X_GetTickCountUs() - updated_us > max_age_ms * 1000)
+    return false;
+  *pRangeMilliMeter = estimate_mm;
+  return true;
+}
+
+// The distance changed all at once (a bin lid opened and closed): drops
+// the window, the next estimate only takes samples measured from now on.
+// Never blocks. The sampler task calls done (if not NULL) once, with the
+// first estimate of the new window, or with ok false after timeout_ms; it
+// must not block the sampler either. A restart before then replaces the
+// callback. Not to be called from more than one task.
+void vl53l0x_level_restart(vl53l0x_level_t* level,
+                           uint32_t timeout_ms,
+                           vl53l0x_read_done_t done,
+                           void* arg) {
+  uint32_t epoch = level->epoch + 1;
+  level->done = done;
+  level->done_arg = arg;
+  level->done_timeout_ms = timeout_ms;
+  level->epoch_us = VL53L0X_GetTickCountUs();
+  // the sampler sees the new epoch only with its start time and callback
+  __sync_synchronize();
+  level->epoch = epoch;
+}